@@ -31,13 +31,7 @@
 /*
  * Global variables
  */
-int numberOfBFs = INITIAL_NUM_OF_BFS;
-int refreshTime = REFRESH_TIME;
 int batchOps = DEFAULT_BATCH_OPS;
-int future = 0;
-int present = 1;
-int pastStart = NUM_OF_BFS - 1;
-int pastEnd = numberOfBFs;
 double appGivenFPR = DEFAULT_FPR;
 
 /* 
@@ -74,8 +68,22 @@ public:
   // Family of bloom filters forming the FBF
   bloom_filter fbf[NUM_OF_BFS];
   bloom_filter newBF;
+  // Size, refresh time and BF indices of this FBF
+  int numberOfBFs;
+  int refreshTime;
+  int future;
+  int present;
+  int pastStart;
+  int pastEnd;
 
   FBF() {
+    numberOfBFs = INITIAL_NUM_OF_BFS;
+    refreshTime = REFRESH_TIME;
+    future = 0;
+    present = 1;
+    pastStart = NUM_OF_BFS - 1;
+    pastEnd = numberOfBFs;
+
     parameters.projected_element_count = 100000;
     parameters.false_positive_probability = 0.0001;
     parameters.random_seed = 0xA5A5A5A5;
@@ -194,7 +202,7 @@ int main(int argc, char *argv[]) {
      * Check if we have BFs left to expand 
      * and refresh time to reduce
      */
-    if ( (numberOfBFs == NUM_OF_BFS) && (refreshTime == MINIMUM_REFRESH_TIME) ) {
+    if ( (oFBF.numberOfBFs == NUM_OF_BFS) && (oFBF.refreshTime == MINIMUM_REFRESH_TIME) ) {
       std::cout<<" INFO:: Number of bloom filters in FBF and refresh time limit reached " <<std::endl;
       break;
     }
@@ -202,7 +210,7 @@ int main(int argc, char *argv[]) {
     /* 
      * Check for refresh time and refresh the FBF
      */
-    if ( t.getElapsedTime() >= refreshTime ) {
+    if ( t.getElapsedTime() >= oFBF.refreshTime ) {
       oFBF.refresh();
       t.start();
     } 
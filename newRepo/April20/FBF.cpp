@@ -16,13 +16,6 @@
 #define DEFAULT_NUM_OF_HASH_FUNCTIONS 3
 #define FUTURE 0
 
-/*
- * Global variables
- */
-unsigned int future = FUTURE;
-unsigned int present = FUTURE + 1;
-unsigned int past = MINIMUM_NUM_OF_BFS - 1;
-
 using namespace std;
 
 /*
@@ -60,6 +53,13 @@ public:
    */
   bloom_filter newBF;
 
+  /*
+   * Future, present and past BFs of this FBF
+   */
+  unsigned int future;
+  unsigned int present;
+  unsigned int past;
+
   /************************************************************ 
    * FUNCTION NAME: FBF 
    *
@@ -91,6 +91,9 @@ public:
       fbf[counter] = baseBF;
     }
     newBF = baseBF;
+    future = FUTURE;
+    present = FUTURE + 1;
+    past = MINIMUM_NUM_OF_BFS - 1;
 
     cout<<" INFO :: FBFs initialized " <<endl;
   }
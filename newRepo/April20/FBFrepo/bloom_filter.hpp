@@ -21,24 +21,28 @@
 #define INCLUDE_BLOOM_FILTER_HPP
 
 #include <cstddef>
+#include <cstdlib>
 #include <algorithm>
 #include <cmath>
 #include <limits>
+#include <new>
 #include <string>
+#include <utility>
 #include <vector>
 
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
 using namespace std;
 static const std::size_t bits_per_char = 0x08;    // 8 bits in 1 char(unsigned)
-static const unsigned char bit_mask[bits_per_char] = {
-                                                       0x01,  //00000001
-                                                       0x02,  //00000010
-                                                       0x04,  //00000100
-                                                       0x08,  //00001000
-                                                       0x10,  //00010000
-                                                       0x20,  //00100000
-                                                       0x40,  //01000000
-                                                       0x80   //10000000
-                                                     };
+static const std::size_t cache_line_size = 0x40;  // 64 bytes per cache line
+static const std::size_t page_size = 0x1000;      // 4096 bytes per page
+static const std::size_t large_table_size = 0x2000000; // 32MB, tables cleared by the kernel
+static const std::size_t huge_page_size = 0x200000;    // 2MB per huge page
 
 class bloom_parameters
 {
@@ -51,7 +55,10 @@ public:
      maximum_number_of_hashes(std::numeric_limits<unsigned int>::max()),
      projected_element_count(10000),
      false_positive_probability(1.0 / projected_element_count),
-     random_seed(0xA5A5A5A55A5A5A5AULL)
+     random_seed(0xA5A5A5A55A5A5A5AULL),
+     hash_mode(salted_hashes),
+     index_mode(modulo_reduction),
+     page_mode(standard_pages)
    {}
 
    virtual ~bloom_parameters()
@@ -90,6 +97,46 @@ public:
 
    unsigned long long int random_seed;
 
+   //How the k bit positions of a key are derived. salted_hashes
+   //runs hash_ap once per salt, double_hashing runs one 64 bit
+   //hash and derives the k positions as h1 + i * h2.
+   enum hash_mode_t
+   {
+      salted_hashes,
+      double_hashing
+   };
+
+   hash_mode_t hash_mode;
+
+   //How a hash is reduced to a bit position in the table.
+   //modulo_reduction uses hash % table_size, multiply_shift uses
+   //(hash * table_size) >> 32 and power_of_two uses a mask, in which
+   //case the table size is rounded up to a power of 2. The mask
+   //keeps the low bits of the hash, so power_of_two is best paired
+   //with double_hashing.
+   enum index_mode_t
+   {
+      modulo_reduction,
+      multiply_shift,
+      power_of_two
+   };
+
+   index_mode_t index_mode;
+
+   //How the bit table is backed. Tables of 2MB or more are aligned
+   //to a huge page in the huge page modes. transparent_huge_pages
+   //asks the kernel for huge pages with madvise(MADV_HUGEPAGE) and
+   //explicit_huge_pages maps the table from the hugetlbfs pool,
+   //falling back to transparent huge pages when the pool is empty.
+   enum page_mode_t
+   {
+      standard_pages,
+      transparent_huge_pages,
+      explicit_huge_pages
+   };
+
+   page_mode_t page_mode;
+
    struct optimal_parameters_t
    {
       optimal_parameters_t()
@@ -155,6 +202,7 @@ public:
          optp.table_size = maximum_size;
 
       optp.table_size = 6250;
+      round_table_size();
 
       std::cout<<"\nTABLE SIZE: "<<sizeof(unsigned long long int)*optp.table_size <<"\n";
 
@@ -212,6 +260,7 @@ public:
          optp.table_size = maximum_size;
 
       optp.table_size = tableSize;
+      round_table_size();
 
       std::cout<<"\n INFO :: TABLE SIZE IN BYTES: "<<sizeof(unsigned long long int)*optp.table_size <<"\n";
 
@@ -219,6 +268,233 @@ public:
       return true;
    }
 
+   inline void round_table_size()
+   {
+      // A mask can only be used as an index reduction on 2^n bits
+      if (power_of_two == index_mode)
+      {
+         unsigned long long int table_size = 1;
+         while (table_size < optimal_parameters.table_size)
+         {
+            table_size <<= 1;
+         }
+         optimal_parameters.table_size = table_size;
+      }
+   }
+
+};
+
+inline std::size_t table_alignment(const std::size_t bytes, const bloom_parameters::page_mode_t mode)
+{
+   // Cache line, page or huge page, see Note 2
+   if ((bloom_parameters::standard_pages != mode) && (bytes >= huge_page_size))
+      return huge_page_size;
+   return (bytes >= large_table_size) ? page_size : cache_line_size;
+}
+
+inline void* allocate_aligned_table(std::size_t bytes, const bloom_parameters::page_mode_t mode, std::size_t& mapped_bytes)
+{
+   // mapped_bytes is non zero when the table has to be unmapped
+   const std::size_t alignment = table_alignment(bytes,mode);
+   bytes += (((bytes % alignment) != 0) ? (alignment - (bytes % alignment)) : 0);
+   void* table = 0;
+   mapped_bytes = 0;
+#if defined(__linux__) && defined(MAP_HUGETLB)
+   if ((bloom_parameters::explicit_huge_pages == mode) && (huge_page_size == alignment))
+   {
+      table = mmap(0,bytes,PROT_READ | PROT_WRITE,MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,-1,0);
+      if (MAP_FAILED != table)
+      {
+         mapped_bytes = bytes;
+         return table;
+      }
+      table = 0;
+   }
+#endif
+   if (0 != posix_memalign(&table,alignment,(0 == bytes) ? alignment : bytes))
+   {
+      throw std::bad_alloc();
+   }
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+   if (huge_page_size == alignment)
+   {
+      madvise(table,bytes,MADV_HUGEPAGE);
+   }
+#endif
+   return table;
+}
+
+inline void release_aligned_table(void* table, const std::size_t mapped_bytes)
+{
+#if defined(__linux__)
+   if (0 != mapped_bytes)
+   {
+      munmap(table,mapped_bytes);
+      return;
+   }
+#endif
+   free(table);
+}
+
+class table_arena
+{
+public:
+
+   /*
+     Note:
+     Carves equally sized bit tables out of a few large aligned slabs,
+     so that all the tables of a set of filters (say the generations
+     of an FBF) sit one slot_stride() apart in a single allocation.
+     The slot size is fixed by the first acquire(), a table that does
+     not fit a slot is refused and left to the caller to allocate.
+     When every slot is taken a new slab with as many slots as all
+     the previous ones is added, the tables already handed out never
+     move. Released slots are kept on a free list, large ones are
+     decommitted first. The arena must outlive the filters using it.
+   */
+   table_arena()
+   : page_mode_(bloom_parameters::standard_pages),
+     slot_bytes_(0),
+     alignment_(cache_line_size),
+     reserved_slots_(1),
+     slot_count_(0),
+     used_slots_(0),
+     slots_in_use_(0)
+   {}
+
+   ~table_arena()
+   {
+      for (std::size_t i = 0; i < slabs_.size(); ++i)
+      {
+         release_aligned_table(slabs_[i],slab_mapped_bytes_[i]);
+      }
+   }
+
+   inline void reserve(const std::size_t slots)
+   {
+      // Number of slots of the first slab
+      reserved_slots_ = (0 == slots) ? 1 : slots;
+   }
+
+   inline void* acquire(const std::size_t bytes, const bloom_parameters::page_mode_t mode = bloom_parameters::standard_pages)
+   {
+      if (slabs_.empty())
+      {
+         page_mode_  = mode;
+         alignment_  = table_alignment(bytes,mode);
+         slot_bytes_ = (0 == bytes) ? alignment_ : bytes;
+         slot_bytes_ += (((slot_bytes_ % alignment_) != 0) ? (alignment_ - (slot_bytes_ % alignment_)) : 0);
+      }
+
+      if (bytes > slot_bytes_)
+         return 0;
+
+      ++slots_in_use_;
+
+      if (!free_slots_.empty())
+      {
+         void* slot = free_slots_.back();
+         free_slots_.pop_back();
+         return slot;
+      }
+
+      if (used_slots_ == slot_count_)
+      {
+         add_slab((0 == slot_count_) ? reserved_slots_ : slot_count_);
+      }
+
+      const std::size_t slot = used_slots_ - (slot_count_ - slab_slots_.back());
+      ++used_slots_;
+      return slabs_.back() + slot * slot_bytes_;
+   }
+
+   inline bool release(void* table)
+   {
+      // False if the table was not carved out of this arena
+      if (!owns(table))
+         return false;
+#if defined(__linux__) && defined(MADV_DONTNEED)
+      if (slot_bytes_ >= large_table_size)
+      {
+         madvise(table,slot_bytes_,MADV_DONTNEED);
+      }
+#endif
+      free_slots_.push_back(table);
+      --slots_in_use_;
+      return true;
+   }
+
+   inline bool owns(const void* table) const
+   {
+      const unsigned char* p = static_cast<const unsigned char*>(table);
+      for (std::size_t i = 0; i < slabs_.size(); ++i)
+      {
+         if ((p >= slabs_[i]) && (p < slabs_[i] + slab_slots_[i] * slot_bytes_))
+            return true;
+      }
+      return false;
+   }
+
+   inline std::size_t slot_stride() const
+   {
+      return slot_bytes_;
+   }
+
+   inline std::size_t allocation_count() const
+   {
+      // Allocations made from the system, one per slab
+      return slabs_.size();
+   }
+
+   inline std::size_t slot_count() const
+   {
+      return slot_count_;
+   }
+
+   inline std::size_t slots_in_use() const
+   {
+      return slots_in_use_;
+   }
+
+   inline std::size_t free_slot_count() const
+   {
+      // Released slots waiting for reuse, the holes of the slabs
+      return free_slots_.size();
+   }
+
+   inline double fragmentation() const
+   {
+      // Fraction of the slabs not holding a live table
+      return (0 == slot_count_) ? 0.0 : 1.0 - (static_cast<double>(slots_in_use_) / slot_count_);
+   }
+
+private:
+
+   table_arena(const table_arena&);
+   table_arena& operator = (const table_arena&);
+
+   inline void add_slab(const std::size_t slots)
+   {
+      // Slots of 2MB or more start on a huge page in the huge page modes
+      std::size_t mapped_bytes = 0;
+      void* slab = allocate_aligned_table(slots * slot_bytes_,page_mode_,mapped_bytes);
+      slabs_.push_back(static_cast<unsigned char*>(slab));
+      slab_mapped_bytes_.push_back(mapped_bytes);
+      slab_slots_.push_back(slots);
+      slot_count_ += slots;
+   }
+
+   std::vector<unsigned char*> slabs_;
+   std::vector<std::size_t>    slab_slots_;
+   std::vector<std::size_t>    slab_mapped_bytes_;
+   std::vector<void*>          free_slots_;
+   bloom_parameters::page_mode_t page_mode_;
+   std::size_t                 slot_bytes_;
+   std::size_t                 alignment_;
+   std::size_t                 reserved_slots_;
+   std::size_t                 slot_count_;
+   std::size_t                 used_slots_;
+   std::size_t                 slots_in_use_;
 };
 
 class bloom_filter
@@ -226,10 +502,70 @@ class bloom_filter
 protected:
 
    typedef unsigned int bloom_type;
-   typedef unsigned char cell_type;
+   typedef unsigned long long int cell_type;
+
+   static const std::size_t bits_per_cell = sizeof(cell_type) * bits_per_char;
 
 public:
 
+   class key_digest
+   {
+   public:
+
+      /*
+        Note:
+        The k bit positions of a key, computed once by compute_digest
+        and accepted by insert/contains of any filter built from the
+        same parameters (same salts, table size, hash and index mode),
+        e.g. every generation of an FBF. The hashes themselves are kept
+        too, see rebase_digest. Up to inline_capacity hashes are kept
+        in place, so a digest on the stack does not allocate.
+      */
+      key_digest()
+      : hash_count_(0)
+      {}
+
+      inline std::size_t* reset(const std::size_t hash_count)
+      {
+         hash_count_ = hash_count;
+         if (hash_count_ <= inline_capacity)
+            return inline_index_;
+         overflow_index_.resize(hash_count_);
+         overflow_hash_.resize(hash_count_);
+         return &overflow_index_[0];
+      }
+
+      inline bloom_type* hash_value()
+      {
+         return (hash_count_ <= inline_capacity) ? inline_hash_ : &overflow_hash_[0];
+      }
+
+      inline const bloom_type* hash_value() const
+      {
+         return (hash_count_ <= inline_capacity) ? inline_hash_ : &overflow_hash_[0];
+      }
+
+      inline std::size_t hash_count() const
+      {
+         return hash_count_;
+      }
+
+      inline const std::size_t* bit_index() const
+      {
+         return (hash_count_ <= inline_capacity) ? inline_index_ : &overflow_index_[0];
+      }
+
+   private:
+
+      static const std::size_t inline_capacity = 16;
+
+      std::size_t hash_count_;
+      std::size_t inline_index_[inline_capacity];
+      bloom_type inline_hash_[inline_capacity];
+      std::vector<std::size_t> overflow_index_;
+      std::vector<bloom_type> overflow_hash_;
+   };
+
    bloom_filter()
    : bit_table_(0),
      salt_count_(0),
@@ -238,29 +574,72 @@ public:
      projected_element_count_(0),
      inserted_element_count_(0),
      random_seed_(0),
-     desired_false_positive_probability_(0.0)
+     desired_false_positive_probability_(0.0),
+     hash_mode_(bloom_parameters::salted_hashes),
+     index_mode_(bloom_parameters::modulo_reduction),
+     page_mode_(bloom_parameters::standard_pages),
+     mapped_bytes_(0),
+     arena_(0)
    {}
 
-   bloom_filter(const bloom_parameters& p)
+   bloom_filter(const bloom_parameters& p, table_arena* arena = 0)
    : bit_table_(0),
      projected_element_count_(p.projected_element_count),
      inserted_element_count_(0),
      random_seed_((p.random_seed * 0xA5A5A5A5) + 1),
-     desired_false_positive_probability_(p.false_positive_probability)
+     desired_false_positive_probability_(p.false_positive_probability),
+     hash_mode_(p.hash_mode),
+     index_mode_(p.index_mode),
+     page_mode_(p.page_mode),
+     mapped_bytes_(0),
+     arena_(arena)
    {
       salt_count_ = p.optimal_parameters.number_of_hashes;
       table_size_ = p.optimal_parameters.table_size;
       generate_unique_salt();
-      raw_table_size_ = table_size_ / bits_per_char;
-      bit_table_ = new cell_type[static_cast<std::size_t>(raw_table_size_)];
+      raw_table_size_ = (table_size_ + bits_per_cell - 1) / bits_per_cell;
+      bit_table_ = allocate_table(raw_table_size_,mapped_bytes_);
       std::fill_n(bit_table_,raw_table_size_,0x00);
    }
 
    bloom_filter(const bloom_filter& filter)
+   : bit_table_(0),
+     mapped_bytes_(0),
+     arena_(0)
    {
       this->operator=(filter);
    }
 
+   bloom_filter(bloom_filter&& filter) noexcept
+   : salt_(std::move(filter.salt_)),
+     bit_table_(filter.bit_table_),
+     salt_count_(filter.salt_count_),
+     table_size_(filter.table_size_),
+     raw_table_size_(filter.raw_table_size_),
+     projected_element_count_(filter.projected_element_count_),
+     inserted_element_count_(filter.inserted_element_count_),
+     random_seed_(filter.random_seed_),
+     desired_false_positive_probability_(filter.desired_false_positive_probability_),
+     hash_mode_(filter.hash_mode_),
+     index_mode_(filter.index_mode_),
+     page_mode_(filter.page_mode_),
+     mapped_bytes_(filter.mapped_bytes_),
+     arena_(filter.arena_)
+   {
+      /*
+        Note:
+        The table is handed over rather than copied and the moved from
+        filter is left empty (!filter is true) but safe to destroy or
+        assign to.
+      */
+      filter.bit_table_ = 0;
+      filter.salt_count_ = 0;
+      filter.table_size_ = 0;
+      filter.raw_table_size_ = 0;
+      filter.inserted_element_count_ = 0;
+      filter.mapped_bytes_ = 0;
+   }
+
    inline bool operator == (const bloom_filter& f) const
    {
       if (this != &f)
@@ -273,6 +652,8 @@ public:
             (inserted_element_count_             == f.inserted_element_count_)             &&
             (random_seed_                        == f.random_seed_)                        &&
             (desired_false_positive_probability_ == f.desired_false_positive_probability_) &&
+            (hash_mode_                          == f.hash_mode_)                          &&
+            (index_mode_                         == f.index_mode_)                         &&
             (salt_                               == f.salt_)                               &&
             std::equal(f.bit_table_,f.bit_table_ + raw_table_size_,bit_table_);
       }
@@ -296,17 +677,47 @@ public:
          inserted_element_count_ = f.inserted_element_count_;
          random_seed_ = f.random_seed_;
          desired_false_positive_probability_ = f.desired_false_positive_probability_;
-         delete[] bit_table_;
-         bit_table_ = new cell_type[static_cast<std::size_t>(raw_table_size_)];
+         hash_mode_ = f.hash_mode_;
+         index_mode_ = f.index_mode_;
+         // The copy shares the arena and the page mode of f
+         release_table(bit_table_,mapped_bytes_);
+         arena_ = f.arena_;
+         page_mode_ = f.page_mode_;
+         bit_table_ = allocate_table(raw_table_size_,mapped_bytes_);
          std::copy(f.bit_table_,f.bit_table_ + raw_table_size_,bit_table_);
          salt_ = f.salt_;
       }
       return *this;
    }
 
+   inline bloom_filter& operator = (bloom_filter&& f) noexcept
+   {
+      // The old table of this filter goes away with f
+      swap(f);
+      return *this;
+   }
+
+   inline void swap(bloom_filter& f) noexcept
+   {
+      std::swap(salt_,f.salt_);
+      std::swap(bit_table_,f.bit_table_);
+      std::swap(salt_count_,f.salt_count_);
+      std::swap(table_size_,f.table_size_);
+      std::swap(raw_table_size_,f.raw_table_size_);
+      std::swap(projected_element_count_,f.projected_element_count_);
+      std::swap(inserted_element_count_,f.inserted_element_count_);
+      std::swap(random_seed_,f.random_seed_);
+      std::swap(desired_false_positive_probability_,f.desired_false_positive_probability_);
+      std::swap(hash_mode_,f.hash_mode_);
+      std::swap(index_mode_,f.index_mode_);
+      std::swap(page_mode_,f.page_mode_);
+      std::swap(mapped_bytes_,f.mapped_bytes_);
+      std::swap(arena_,f.arena_);
+   }
+
    virtual ~bloom_filter()
    {
-      delete[] bit_table_;
+      release_table(bit_table_,mapped_bytes_);
    }
 
    inline bool operator!() const
@@ -316,18 +727,64 @@ public:
 
    inline void clear()
    {
-      std::fill_n(bit_table_,raw_table_size_,0x00);
+      /*
+        Note:
+        Large tables are page aligned and handed back to the kernel
+        with madvise(MADV_DONTNEED), which maps them to the zero page.
+        The clear then costs no memory traffic, pages are only faulted
+        back in as inserts touch them and untouched pages use no memory.
+      */
+      if (!decommit_table(bit_table_,raw_table_size_))
+      {
+         std::fill_n(bit_table_,raw_table_size_,0x00);
+      }
+      inserted_element_count_ = 0;
+   }
+
+   inline bool clear_step(std::size_t& cursor, const std::size_t cells)
+   {
+      /*
+        Note:
+        Zeroes up to the given number of table cells (64 bits each)
+        from cursor onwards and moves cursor past them, so that a
+        table can be cleared a little at a time. Returns true once
+        the whole table is clear, the filter is only empty then.
+      */
+      if (cursor < raw_table_size_)
+      {
+         const std::size_t end = std::min<std::size_t>(cursor + cells,raw_table_size_);
+         std::fill(bit_table_ + cursor,bit_table_ + end,0x00);
+         cursor = end;
+         if (cursor < raw_table_size_)
+            return false;
+      }
       inserted_element_count_ = 0;
+      return true;
    }
 
    inline void insert(const unsigned char* key_begin, const std::size_t& length)
    {
       std::size_t bit_index = 0;
       std::size_t bit = 0;
-      for (std::size_t i = 0; i < salt_.size(); ++i)
+      if (bloom_parameters::double_hashing == hash_mode_)
       {
-         compute_indices(hash_ap(key_begin,length,salt_[i]),bit_index,bit);
-         bit_table_[bit_index / bits_per_char] |= bit_mask[bit];
+         bloom_type hash = 0;
+         bloom_type step = 0;
+         compute_double_hash(key_begin,length,hash,step);
+         for (std::size_t i = 0; i < salt_.size(); ++i)
+         {
+            compute_indices(hash,bit_index,bit);
+            bit_table_[bit_index / bits_per_cell] |= (static_cast<cell_type>(1) << bit);
+            hash += step;
+         }
+      }
+      else
+      {
+         for (std::size_t i = 0; i < salt_.size(); ++i)
+         {
+            compute_indices(hash_ap(key_begin,length,salt_[i]),bit_index,bit);
+            bit_table_[bit_index / bits_per_cell] |= (static_cast<cell_type>(1) << bit);
+         }
       }
       ++inserted_element_count_;
    }
@@ -349,6 +806,16 @@ public:
       insert(reinterpret_cast<const unsigned char*>(data),length);
    }
 
+   inline void insert(const key_digest& digest)
+   {
+      const std::size_t* bit_index = digest.bit_index();
+      for (std::size_t i = 0; i < digest.hash_count(); ++i)
+      {
+         bit_table_[bit_index[i] / bits_per_cell] |= (static_cast<cell_type>(1) << (bit_index[i] % bits_per_cell));
+      }
+      ++inserted_element_count_;
+   }
+
    template<typename InputIterator>
    inline void insert(const InputIterator begin, const InputIterator end)
    {
@@ -363,10 +830,26 @@ public:
    {
       std::size_t bit_index = 0;
       std::size_t bit = 0;
+      if (bloom_parameters::double_hashing == hash_mode_)
+      {
+         bloom_type hash = 0;
+         bloom_type step = 0;
+         compute_double_hash(key_begin,length,hash,step);
+         for (std::size_t i = 0; i < salt_.size(); ++i)
+         {
+            compute_indices(hash,bit_index,bit);
+            if (0 == (bit_table_[bit_index / bits_per_cell] & (static_cast<cell_type>(1) << bit)))
+            {
+               return false;
+            }
+            hash += step;
+         }
+         return true;
+      }
       for (std::size_t i = 0; i < salt_.size(); ++i)
       {
          compute_indices(hash_ap(key_begin,length,salt_[i]),bit_index,bit);
-         if ((bit_table_[bit_index / bits_per_char] & bit_mask[bit]) != bit_mask[bit])
+         if (0 == (bit_table_[bit_index / bits_per_cell] & (static_cast<cell_type>(1) << bit)))
          {
             return false;
          }
@@ -390,6 +873,109 @@ public:
       return contains(reinterpret_cast<const unsigned char*>(data),length);
    }
 
+   inline bool contains(const key_digest& digest) const
+   {
+      const std::size_t* bit_index = digest.bit_index();
+      for (std::size_t i = 0; i < digest.hash_count(); ++i)
+      {
+         if (0 == (bit_table_[bit_index[i] / bits_per_cell] & (static_cast<cell_type>(1) << (bit_index[i] % bits_per_cell))))
+         {
+            return false;
+         }
+      }
+      return true;
+   }
+
+   inline void insert_atomic(const key_digest& digest)
+   {
+      /*
+        Note:
+        Safe to call from several threads at once and alongside
+        contains_atomic. Each bit is set with an atomic OR on its 64 bit
+        cell, so concurrent inserts into the same cell never lose a bit.
+        Relaxed ordering is enough as bits are only ever set, a reader
+        that must see them has to synchronize with the writer anyway.
+      */
+      const std::size_t* bit_index = digest.bit_index();
+      for (std::size_t i = 0; i < digest.hash_count(); ++i)
+      {
+         __atomic_fetch_or(&bit_table_[bit_index[i] / bits_per_cell],static_cast<cell_type>(1) << (bit_index[i] % bits_per_cell),__ATOMIC_RELAXED);
+      }
+      __atomic_fetch_add(&inserted_element_count_,1,__ATOMIC_RELAXED);
+   }
+
+   inline bool contains_atomic(const key_digest& digest) const
+   {
+      const std::size_t* bit_index = digest.bit_index();
+      for (std::size_t i = 0; i < digest.hash_count(); ++i)
+      {
+         if (0 == (__atomic_load_n(&bit_table_[bit_index[i] / bits_per_cell],__ATOMIC_RELAXED) & (static_cast<cell_type>(1) << (bit_index[i] % bits_per_cell))))
+         {
+            return false;
+         }
+      }
+      return true;
+   }
+
+   inline void compute_digest(const unsigned char* key_begin, const std::size_t& length, key_digest& digest) const
+   {
+      std::size_t* bit_index = digest.reset(salt_.size());
+      bloom_type* hash_value = digest.hash_value();
+      std::size_t bit = 0;
+      if (bloom_parameters::double_hashing == hash_mode_)
+      {
+         bloom_type hash = 0;
+         bloom_type step = 0;
+         compute_double_hash(key_begin,length,hash,step);
+         for (std::size_t i = 0; i < salt_.size(); ++i)
+         {
+            hash_value[i] = hash;
+            compute_indices(hash,bit_index[i],bit);
+            hash += step;
+         }
+      }
+      else
+      {
+         for (std::size_t i = 0; i < salt_.size(); ++i)
+         {
+            hash_value[i] = hash_ap(key_begin,length,salt_[i]);
+            compute_indices(hash_value[i],bit_index[i],bit);
+         }
+      }
+   }
+
+   inline void rebase_digest(const key_digest& source, key_digest& digest) const
+   {
+      /*
+        Note:
+        Maps a digest computed by a filter with the same salts, hash
+        and index mode but another table size onto this table. Only
+        the index reduction is redone, so a key is hashed once for
+        filters of different sizes, e.g. an FBF and its summaries.
+      */
+      std::size_t* bit_index = digest.reset(source.hash_count());
+      bloom_type* hash_value = digest.hash_value();
+      const bloom_type* source_hash = source.hash_value();
+      std::size_t bit = 0;
+      for (std::size_t i = 0; i < source.hash_count(); ++i)
+      {
+         hash_value[i] = source_hash[i];
+         compute_indices(hash_value[i],bit_index[i],bit);
+      }
+   }
+
+   template<typename T>
+   inline void compute_digest(const T& t, key_digest& digest) const
+   {
+      // Note: T must be a C++ POD type.
+      compute_digest(reinterpret_cast<const unsigned char*>(&t),sizeof(T),digest);
+   }
+
+   inline void compute_digest(const std::string& key, key_digest& digest) const
+   {
+      compute_digest(reinterpret_cast<const unsigned char*>(key.c_str()),key.size(),digest);
+   }
+
    template<typename InputIterator>
    inline InputIterator contains_all(const InputIterator begin, const InputIterator end) const
    {
@@ -420,9 +1006,33 @@ public:
       return end;
    }
 
-   inline virtual unsigned long long int size() const
+   inline virtual void contains_batch(const unsigned long long int* keys, const std::size_t count, unsigned long long int* bitmap) const
    {
-      return table_size_;
+      /*
+        Note:
+        Bit i of the bitmap is set when keys[i] is contained in the
+        filter. The bitmap must hold (count + 63) / 64 words. When
+        compiled with -mavx2 the keys are looked up 8 at a time,
+        hashes, bit positions and the probe results are computed
+        in vector lanes without branching on individual bits.
+      */
+      std::fill_n(bitmap,(count + 63) / 64,0x00);
+      std::size_t i = 0;
+#if defined(__AVX2__)
+      if ((table_size_ < 0x80000000ULL) && (bloom_parameters::salted_hashes == hash_mode_))
+      {
+         for (; (i + 8) <= count; i += 8)
+         {
+            bitmap[i / 64] |= static_cast<unsigned long long int>(contains8_avx2(keys + i)) << (i % 64);
+         }
+      }
+#endif
+      contains_batch_scalar(keys,i,count,bitmap);
+   }
+
+   inline virtual unsigned long long int size() const
+   {
+      return table_size_;
    }
 
    inline std::size_t element_count() const
@@ -430,6 +1040,27 @@ public:
       return inserted_element_count_;
    }
 
+   inline void add_element_count(const std::size_t count)
+   {
+      /*
+        Note:
+        The union operators only OR the tables, a caller merging
+        another filter into this one accounts for its elements here.
+      */
+      inserted_element_count_ += static_cast<unsigned int>(count);
+   }
+
+   inline unsigned long long int bit_count() const
+   {
+      // Number of bits set in the table
+      unsigned long long int count = 0;
+      for (std::size_t i = 0; i < raw_table_size_; ++i)
+      {
+         count += __builtin_popcountll(bit_table_[i]);
+      }
+      return count;
+   }
+
    inline double effective_fpp() const
    {
       /*
@@ -456,7 +1087,9 @@ public:
       if (
           (salt_count_  == f.salt_count_) &&
           (table_size_  == f.table_size_) &&
-          (random_seed_ == f.random_seed_)
+          (random_seed_ == f.random_seed_) &&
+          (hash_mode_   == f.hash_mode_)   &&
+          (index_mode_  == f.index_mode_)
          )
       {
          for (std::size_t i = 0; i < raw_table_size_; ++i)
@@ -473,10 +1106,30 @@ public:
       if (
           (salt_count_  == f.salt_count_) &&
           (table_size_  == f.table_size_) &&
-          (random_seed_ == f.random_seed_)
+          (random_seed_ == f.random_seed_) &&
+          (hash_mode_   == f.hash_mode_)   &&
+          (index_mode_  == f.index_mode_)
          )
       {
-         for (std::size_t i = 0; i < raw_table_size_; ++i)
+         std::size_t i = 0;
+#if defined(__AVX2__)
+         /*
+           Note:
+           Four cells at a time, a zero vector of f is skipped so that
+           merging a sparse table, eg a delta filter, does not dirty
+           the cache lines of this one.
+         */
+         for (; (i + 4) <= raw_table_size_; i += 4)
+         {
+            const __m256i other = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(f.bit_table_ + i));
+            if (!_mm256_testz_si256(other,other))
+            {
+               __m256i* cells = reinterpret_cast<__m256i*>(bit_table_ + i);
+               _mm256_storeu_si256(cells,_mm256_or_si256(_mm256_loadu_si256(cells),other));
+            }
+         }
+#endif
+         for (; i < raw_table_size_; ++i)
          {
             bit_table_[i] |= f.bit_table_[i];
          }
@@ -490,7 +1143,9 @@ public:
       if (
           (salt_count_  == f.salt_count_) &&
           (table_size_  == f.table_size_) &&
-          (random_seed_ == f.random_seed_)
+          (random_seed_ == f.random_seed_) &&
+          (hash_mode_   == f.hash_mode_)   &&
+          (index_mode_  == f.index_mode_)
          )
       {
          for (std::size_t i = 0; i < raw_table_size_; ++i)
@@ -513,12 +1168,153 @@ public:
 
 protected:
 
+   inline cell_type* allocate_table(const unsigned long long int raw_size, std::size_t& mapped_bytes)
+   {
+      // raw_size is a number of cells, not bytes
+      /*
+        Note:
+        A filter given an arena takes its table from there when it
+        fits a slot, otherwise the table is allocated on its own with
+        the alignment of Note 2.
+      */
+      void* table = 0;
+      const std::size_t bytes = static_cast<std::size_t>(raw_size) * sizeof(cell_type);
+      mapped_bytes = 0;
+      if (arena_ && (0 != (table = arena_->acquire(bytes,page_mode_))))
+      {
+         return static_cast<cell_type*>(table);
+      }
+      return static_cast<cell_type*>(allocate_aligned_table(bytes,page_mode_,mapped_bytes));
+   }
+
+   static inline bool decommit_table(cell_type* table, const std::size_t raw_size)
+   {
+      // Zero a large table through the kernel, false if it was not done
+      const std::size_t bytes = raw_size * sizeof(cell_type);
+      if (bytes < large_table_size)
+         return false;
+#if defined(__linux__) && defined(MADV_DONTNEED)
+      // Any partial last page is zeroed by hand
+      const std::size_t whole_pages = bytes - (bytes % page_size);
+      if (0 != madvise(table,whole_pages,MADV_DONTNEED))
+         return false;
+      std::fill(reinterpret_cast<unsigned char*>(table) + whole_pages,reinterpret_cast<unsigned char*>(table) + bytes,0x00);
+      return true;
+#else
+      return false;
+#endif
+   }
+
+   inline void release_table(cell_type* table, const std::size_t mapped_bytes)
+   {
+      if (arena_ && arena_->release(table))
+         return;
+      release_aligned_table(table,mapped_bytes);
+   }
+
+   inline std::size_t reduce_index(const bloom_type& hash, const unsigned long long int& range) const
+   {
+      /*
+        Note:
+        multiply_shift maps the 32 bit hash onto [0,range) with a
+        multiplication and a shift instead of a 64 bit division, and
+        power_of_two relies on range being 2^n.
+      */
+      switch (index_mode_)
+      {
+         case bloom_parameters::multiply_shift : return static_cast<std::size_t>((static_cast<unsigned long long int>(hash) * range) >> 32);
+         case bloom_parameters::power_of_two   : return static_cast<std::size_t>(hash & (range - 1));
+         default                               : return static_cast<std::size_t>(hash % range);
+      }
+   }
+
    inline virtual void compute_indices(const bloom_type& hash, std::size_t& bit_index, std::size_t& bit) const
    {
-      bit_index = hash % table_size_;
-      bit = bit_index % bits_per_char;
+      bit_index = reduce_index(hash,table_size_);
+      bit = bit_index % bits_per_cell;
+   }
+
+   inline void contains_batch_scalar(const unsigned long long int* keys, std::size_t begin, const std::size_t count, unsigned long long int* bitmap) const
+   {
+      for (std::size_t i = begin; i < count; ++i)
+      {
+         if (contains(reinterpret_cast<const unsigned char*>(keys + i),sizeof(unsigned long long int)))
+         {
+            bitmap[i / 64] |= 1ULL << (i % 64);
+         }
+      }
    }
 
+#if defined(__AVX2__)
+   inline unsigned int contains8_avx2(const unsigned long long int* keys) const
+   {
+      /*
+        Note:
+        For an 8 byte key hash_ap runs a single round in which every
+        term but i1 and i2 only depends on the salt, so it is computed
+        lane wise here. The index reduction follows index_mode_, with
+        hash % table_size_ done in double precision (exact for 32 bit
+        operands), and each probe gathers the 32 bit word holding the
+        bit.
+      */
+      const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys));
+      const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + 4));
+      const __m256i i1 = _mm256_permute4x64_epi64(_mm256_castps_si256(_mm256_shuffle_ps(_mm256_castsi256_ps(lo),_mm256_castsi256_ps(hi),_MM_SHUFFLE(2,0,2,0))),_MM_SHUFFLE(3,1,2,0));
+      const __m256i i2 = _mm256_permute4x64_epi64(_mm256_castps_si256(_mm256_shuffle_ps(_mm256_castsi256_ps(lo),_mm256_castsi256_ps(hi),_MM_SHUFFLE(3,1,3,1))),_MM_SHUFFLE(3,1,2,0));
+
+      const __m256d table_size = _mm256_set1_pd(static_cast<double>(table_size_));
+      const __m256i table_size_lanes = _mm256_set1_epi64x(static_cast<long long int>(table_size_));
+      const __m256i table_mask = _mm256_set1_epi32(static_cast<int>(table_size_ - 1));
+      const __m256d two_pow_32 = _mm256_set1_pd(4294967296.0);
+      const __m256d zero = _mm256_setzero_pd();
+      const __m256i low_bits = _mm256_set1_epi32(0x1F);
+      const __m256i one = _mm256_set1_epi32(0x01);
+      __m256i result = _mm256_set1_epi32(-1);
+
+      for (std::size_t i = 0; i < salt_.size(); ++i)
+      {
+         const bloom_type salt = salt_[i];
+         __m256i hash = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(salt << 11)),
+                                         _mm256_xor_si256(i2,_mm256_set1_epi32(static_cast<int>(salt >> 5))));
+         hash = _mm256_xor_si256(hash,_mm256_set1_epi32(-1));
+         hash = _mm256_xor_si256(hash,_mm256_mullo_epi32(i1,_mm256_set1_epi32(static_cast<int>(salt >> 3))));
+         hash = _mm256_xor_si256(hash,_mm256_set1_epi32(static_cast<int>(salt ^ (salt << 7))));
+
+         __m256i bit_index;
+         if (bloom_parameters::power_of_two == index_mode_)
+         {
+            bit_index = _mm256_and_si256(hash,table_mask);
+         }
+         else if (bloom_parameters::multiply_shift == index_mode_)
+         {
+            const __m256i even = _mm256_srli_epi64(_mm256_mul_epu32(hash,table_size_lanes),32);
+            const __m256i odd  = _mm256_mul_epu32(_mm256_srli_epi64(hash,32),table_size_lanes);
+            bit_index = _mm256_blend_epi32(even,odd,0xAA);
+         }
+         else
+         {
+            __m256d h0 = _mm256_cvtepi32_pd(_mm256_castsi256_si128(hash));
+            __m256d h1 = _mm256_cvtepi32_pd(_mm256_extracti128_si256(hash,1));
+            h0 = _mm256_add_pd(h0,_mm256_and_pd(_mm256_cmp_pd(h0,zero,_CMP_LT_OQ),two_pow_32));
+            h1 = _mm256_add_pd(h1,_mm256_and_pd(_mm256_cmp_pd(h1,zero,_CMP_LT_OQ),two_pow_32));
+            h0 = _mm256_sub_pd(h0,_mm256_mul_pd(_mm256_floor_pd(_mm256_div_pd(h0,table_size)),table_size));
+            h1 = _mm256_sub_pd(h1,_mm256_mul_pd(_mm256_floor_pd(_mm256_div_pd(h1,table_size)),table_size));
+            bit_index = _mm256_set_m128i(_mm256_cvttpd_epi32(h1),_mm256_cvttpd_epi32(h0));
+         }
+
+         const __m256i word = _mm256_i32gather_epi32(reinterpret_cast<const int*>(bit_table_),_mm256_srli_epi32(bit_index,5),4);
+         result = _mm256_and_si256(result,_mm256_srlv_epi32(word,_mm256_and_si256(bit_index,low_bits)));
+         result = _mm256_and_si256(result,one);
+
+         if (_mm256_testz_si256(result,result))
+         {
+            return 0;
+         }
+      }
+      return static_cast<unsigned int>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_slli_epi32(result,31))));
+   }
+#endif
+
    void generate_unique_salt()
    {
       /*
@@ -640,8 +1436,60 @@ protected:
       return hash;
    }
 
+   inline unsigned long long int hash_64(const unsigned char* begin, std::size_t remaining_length) const
+   {
+      /*
+        Note:
+        MurmurHash64A (Austin Appleby, public domain) seeded with the
+        random seed of the filter. Used by the double hashing mode,
+        where one strong hash has to stand in for all k salted ones.
+      */
+      const unsigned long long int m = 0xC6A4A7935BD1E995ULL;
+      const int r = 47;
+      const unsigned char* itr = begin;
+      unsigned long long int hash = random_seed_ ^ (remaining_length * m);
+      while (remaining_length >= 8)
+      {
+         unsigned long long int k = *(reinterpret_cast<const unsigned long long int*>(itr)); itr += sizeof(unsigned long long int);
+         k *= m;
+         k ^= k >> r;
+         k *= m;
+         hash ^= k;
+         hash *= m;
+         remaining_length -= 8;
+      }
+      switch (remaining_length)
+      {
+         case 7 : hash ^= static_cast<unsigned long long int>(itr[6]) << 48; // fall through
+         case 6 : hash ^= static_cast<unsigned long long int>(itr[5]) << 40; // fall through
+         case 5 : hash ^= static_cast<unsigned long long int>(itr[4]) << 32; // fall through
+         case 4 : hash ^= static_cast<unsigned long long int>(itr[3]) << 24; // fall through
+         case 3 : hash ^= static_cast<unsigned long long int>(itr[2]) << 16; // fall through
+         case 2 : hash ^= static_cast<unsigned long long int>(itr[1]) << 8; // fall through
+         case 1 : hash ^= static_cast<unsigned long long int>(itr[0]);
+                  hash *= m;
+      }
+      hash ^= hash >> r;
+      hash *= m;
+      hash ^= hash >> r;
+      return hash;
+   }
+
+   inline void compute_double_hash(const unsigned char* key_begin, const std::size_t& length, bloom_type& hash, bloom_type& step) const
+   {
+      /*
+        Note:
+        Kirsch-Mitzenmacher: the i-th hash is h1 + i * h2, with h1 and
+        h2 the two halves of hash_64. The step is kept odd so that it
+        can never collapse all k probes onto one bit.
+      */
+      const unsigned long long int h = hash_64(key_begin,length);
+      hash = static_cast<bloom_type>(h);
+      step = static_cast<bloom_type>(h >> 32) | 0x01;
+   }
+
    std::vector<bloom_type> salt_;
-   unsigned char*          bit_table_;
+   cell_type*              bit_table_;
    unsigned int            salt_count_;
    unsigned long long int  table_size_;
    unsigned long long int  raw_table_size_;
@@ -649,8 +1497,18 @@ protected:
    unsigned int            inserted_element_count_;
    unsigned long long int  random_seed_;
    double                  desired_false_positive_probability_;
+   bloom_parameters::hash_mode_t hash_mode_;
+   bloom_parameters::index_mode_t index_mode_;
+   bloom_parameters::page_mode_t page_mode_;
+   std::size_t             mapped_bytes_;
+   table_arena*            arena_;
 };
 
+inline void swap(bloom_filter& a, bloom_filter& b) noexcept
+{
+   a.swap(b);
+}
+
 inline bloom_filter operator & (const bloom_filter& a, const bloom_filter& b)
 {
    bloom_filter result = a;
@@ -687,6 +1545,12 @@ public:
       return size_list.back();
    }
 
+   inline void contains_batch(const unsigned long long int* keys, const std::size_t count, unsigned long long int* bitmap) const
+   {
+      std::fill_n(bitmap,(count + 63) / 64,0x00);
+      contains_batch_scalar(keys,0,count,bitmap);
+   }
+
    inline bool compress(const double& percentage)
    {
       if ((0.0 >= percentage) || (percentage >= 100.0))
@@ -696,27 +1560,35 @@ public:
 
       unsigned long long int original_table_size = size_list.back();
       unsigned long long int new_table_size = static_cast<unsigned long long int>((size_list.back() * (1.0 - (percentage / 100.0))));
-      new_table_size -= (((new_table_size % bits_per_char) != 0) ? (new_table_size % bits_per_char) : 0);
+      new_table_size -= (((new_table_size % bits_per_cell) != 0) ? (new_table_size % bits_per_cell) : 0);
 
-      if ((bits_per_char > new_table_size) || (new_table_size >= original_table_size))
+      if ((bits_per_cell > new_table_size) || (new_table_size >= original_table_size))
       {
          return false;
       }
 
+      /*
+        Note:
+        The new size is a whole number of cells, so folding bit b onto
+        b - new_table_size (see compute_indices) is a cell wise OR of
+        the tail of the table onto its start, wrapping as often as the
+        tail is longer than the new table.
+      */
+      const std::size_t new_raw_size = static_cast<std::size_t>(new_table_size / bits_per_cell);
       desired_false_positive_probability_ = effective_fpp();
-      cell_type* tmp = new cell_type[static_cast<std::size_t>(new_table_size / bits_per_char)];
-      std::copy(bit_table_, bit_table_ + (new_table_size / bits_per_char), tmp);
-      cell_type* itr = bit_table_ + (new_table_size / bits_per_char);
-      cell_type* end = bit_table_ + (original_table_size / bits_per_char);
-      cell_type* itr_tmp = tmp;
+      std::size_t tmp_mapped_bytes = 0;
+      cell_type* tmp = allocate_table(new_raw_size,tmp_mapped_bytes);
+      std::copy(bit_table_, bit_table_ + new_raw_size, tmp);
 
-      while (end != itr)
+      for (std::size_t i = new_raw_size; i < raw_table_size_; ++i)
       {
-         *(itr_tmp++) |= (*itr++);
+         tmp[i % new_raw_size] |= bit_table_[i];
       }
 
-      delete[] bit_table_;
+      release_table(bit_table_,mapped_bytes_);
       bit_table_ = tmp;
+      mapped_bytes_ = tmp_mapped_bytes;
+      raw_table_size_ = new_raw_size;
       size_list.push_back(new_table_size);
 
       return true;
@@ -726,28 +1598,467 @@ private:
 
    inline void compute_indices(const bloom_type& hash, std::size_t& bit_index, std::size_t& bit) const
    {
-      bit_index = hash;
-      for (std::size_t i = 0; i < size_list.size(); ++i)
+      /*
+        Note:
+        Every compression folds the bits beyond the new size back onto
+        the start of the table, so after the first reduction a bit index
+        only needs the sizes subtracted, not a modulo per size.
+      */
+      bit_index = reduce_index(hash,size_list[0]);
+      for (std::size_t i = 1; i < size_list.size(); ++i)
       {
-         bit_index %= size_list[i];
+         while (bit_index >= size_list[i])
+         {
+            bit_index -= static_cast<std::size_t>(size_list[i]);
+         }
       }
-      bit = bit_index % bits_per_char;
+      bit = bit_index % bits_per_cell;
    }
 
    std::vector<unsigned long long int> size_list;
 };
 
+class blocked_bloom_filter : public bloom_filter
+{
+public:
+
+   /*
+     Note:
+     All k bits of a key are placed in a single cache line sized
+     block, so an insert or a lookup touches one cache line no
+     matter how many hash functions are in use. The block is picked
+     by one hash and the k bit positions inside it are derived from
+     a second hash with an odd stride, which keeps them distinct.
+   */
+   static const std::size_t bits_per_block = cache_line_size * bits_per_char;
+
+   blocked_bloom_filter()
+   : bloom_filter(),
+     block_count_(0)
+   {}
+
+   blocked_bloom_filter(const bloom_parameters& p, table_arena* arena = 0)
+   : bloom_filter(block_parameters(p),arena)
+   {
+      block_count_ = table_size_ / bits_per_block;
+   }
+
+   blocked_bloom_filter(const blocked_bloom_filter& filter)
+   : bloom_filter(filter),
+     block_count_(filter.block_count_)
+   {}
+
+   blocked_bloom_filter(blocked_bloom_filter&& filter) noexcept
+   : bloom_filter(std::move(filter)),
+     block_count_(filter.block_count_)
+   {
+      filter.block_count_ = 0;
+   }
+
+   inline blocked_bloom_filter& operator = (const blocked_bloom_filter& f)
+   {
+      bloom_filter::operator=(f);
+      block_count_ = f.block_count_;
+      return *this;
+   }
+
+   inline blocked_bloom_filter& operator = (blocked_bloom_filter&& f) noexcept
+   {
+      swap(f);
+      return *this;
+   }
+
+   inline void swap(blocked_bloom_filter& f) noexcept
+   {
+      bloom_filter::swap(f);
+      std::swap(block_count_,f.block_count_);
+   }
+
+   class key_digest
+   {
+   public:
+
+      // Block of the key and the walk of its k bits inside the block,
+      // block_hash is kept for rebase_digest
+      key_digest()
+      : block_hash(0),
+        block_offset(0),
+        bit(0),
+        stride(0),
+        hash_count(0)
+      {}
+
+      bloom_type block_hash;
+      std::size_t block_offset;
+      std::size_t bit;
+      std::size_t stride;
+      std::size_t hash_count;
+   };
+
+   inline void insert(const key_digest& digest)
+   {
+      cell_type* block = bit_table_ + digest.block_offset;
+      std::size_t bit = digest.bit;
+      for (std::size_t i = 0; i < digest.hash_count; ++i)
+      {
+         block[bit / bits_per_cell] |= (static_cast<cell_type>(1) << (bit % bits_per_cell));
+         bit = (bit + digest.stride) % bits_per_block;
+      }
+      ++inserted_element_count_;
+   }
+
+   inline void insert(const unsigned char* key_begin, const std::size_t& length)
+   {
+      key_digest digest;
+      compute_digest(key_begin,length,digest);
+      insert(digest);
+   }
+
+   template<typename T>
+   inline void insert(const T& t)
+   {
+      // Note: T must be a C++ POD type.
+      insert(reinterpret_cast<const unsigned char*>(&t),sizeof(T));
+   }
+
+   inline void insert(const std::string& key)
+   {
+      insert(reinterpret_cast<const unsigned char*>(key.c_str()),key.size());
+   }
+
+   inline void insert(const char* data, const std::size_t& length)
+   {
+      insert(reinterpret_cast<const unsigned char*>(data),length);
+   }
+
+   inline bool contains(const key_digest& digest) const
+   {
+      const cell_type* block = bit_table_ + digest.block_offset;
+      std::size_t bit = digest.bit;
+      for (std::size_t i = 0; i < digest.hash_count; ++i)
+      {
+         if (0 == (block[bit / bits_per_cell] & (static_cast<cell_type>(1) << (bit % bits_per_cell))))
+         {
+            return false;
+         }
+         bit = (bit + digest.stride) % bits_per_block;
+      }
+      return true;
+   }
+
+   inline virtual bool contains(const unsigned char* key_begin, const std::size_t length) const
+   {
+      key_digest digest;
+      compute_digest(key_begin,length,digest);
+      return contains(digest);
+   }
+
+   template<typename T>
+   inline bool contains(const T& t) const
+   {
+      return contains(reinterpret_cast<const unsigned char*>(&t),static_cast<std::size_t>(sizeof(T)));
+   }
+
+   inline bool contains(const std::string& key) const
+   {
+      return contains(reinterpret_cast<const unsigned char*>(key.c_str()),key.size());
+   }
+
+   inline bool contains(const char* data, const std::size_t& length) const
+   {
+      return contains(reinterpret_cast<const unsigned char*>(data),length);
+   }
+
+   inline void contains_batch(const unsigned long long int* keys, const std::size_t count, unsigned long long int* bitmap) const
+   {
+      std::fill_n(bitmap,(count + 63) / 64,0x00);
+      contains_batch_scalar(keys,0,count,bitmap);
+   }
+
+   inline void compute_digest(const unsigned char* key_begin, const std::size_t& length, key_digest& digest) const
+   {
+      /*
+        Note:
+        The low bits of hash_ap only depend on the low bits of the key,
+        and block_count_ is often a power of 2, so both hashes are
+        passed through a finalizer before being reduced.
+      */
+      bloom_type block_hash = 0;
+      bloom_type bit_hash = 0;
+      if (bloom_parameters::double_hashing == hash_mode_)
+      {
+         const unsigned long long int hash = hash_64(key_begin,length);
+         block_hash = static_cast<bloom_type>(hash);
+         bit_hash   = static_cast<bloom_type>(hash >> 32);
+      }
+      else
+      {
+         block_hash = finalize(hash_ap(key_begin,length,salt_[0]));
+         bit_hash   = finalize(hash_ap(key_begin,length,salt_[salt_.size() - 1] ^ block_hash));
+      }
+      digest.block_hash   = block_hash;
+      digest.block_offset = reduce_index(block_hash,block_count_) * (cache_line_size / sizeof(cell_type));
+      digest.bit          = bit_hash % bits_per_block;
+      digest.stride       = ((bit_hash / bits_per_block) * 2 + 1) % bits_per_block;
+      digest.hash_count   = salt_.size();
+   }
+
+   inline void rebase_digest(const key_digest& source, key_digest& digest) const
+   {
+      // Only the block depends on the table size
+      digest = source;
+      digest.block_offset = reduce_index(source.block_hash,block_count_) * (cache_line_size / sizeof(cell_type));
+   }
+
+   template<typename T>
+   inline void compute_digest(const T& t, key_digest& digest) const
+   {
+      // Note: T must be a C++ POD type.
+      compute_digest(reinterpret_cast<const unsigned char*>(&t),sizeof(T),digest);
+   }
+
+   inline void compute_digest(const std::string& key, key_digest& digest) const
+   {
+      compute_digest(reinterpret_cast<const unsigned char*>(key.c_str()),key.size(),digest);
+   }
+
+   inline unsigned long long int block_count() const
+   {
+      return block_count_;
+   }
+
+private:
+
+   static inline bloom_parameters block_parameters(const bloom_parameters& p)
+   {
+      // Round the table up to a whole number of blocks
+      bloom_parameters bp = p;
+      unsigned long long int& table_size = bp.optimal_parameters.table_size;
+      table_size += (((table_size % bits_per_block) != 0) ? (bits_per_block - (table_size % bits_per_block)) : 0);
+      return bp;
+   }
+
+   static inline bloom_type finalize(bloom_type hash)
+   {
+      hash ^= hash >> 16;
+      hash *= 0x85EBCA6B;
+      hash ^= hash >> 13;
+      hash *= 0xC2B2AE35;
+      hash ^= hash >> 16;
+      return hash;
+   }
+
+private:
+
+   unsigned long long int block_count_;
+};
+
+inline void swap(blocked_bloom_filter& a, blocked_bloom_filter& b) noexcept
+{
+   a.swap(b);
+}
+
+class epoch_bloom_filter : public blocked_bloom_filter
+{
+public:
+
+   /*
+     Note:
+     A blocked filter where every block carries an epoch tag. A block
+     whose tag is not the current epoch reads as zero and is zeroed on
+     its first write, so clear() only has to bump the epoch and takes
+     constant time whatever the table size. The tags cost 4 bytes per
+     64 byte block. Equality and the set operations would see the
+     leftover bits of stale blocks, so they are not available.
+   */
+   epoch_bloom_filter()
+   : blocked_bloom_filter(),
+     epoch_(0)
+   {}
+
+   epoch_bloom_filter(const bloom_parameters& p, table_arena* arena = 0)
+   : blocked_bloom_filter(p,arena),
+     block_epoch_(block_count(),0),
+     epoch_(0)
+   {}
+
+   epoch_bloom_filter(const epoch_bloom_filter& filter)
+   : blocked_bloom_filter(filter),
+     block_epoch_(filter.block_epoch_),
+     epoch_(filter.epoch_)
+   {}
+
+   epoch_bloom_filter(epoch_bloom_filter&& filter) noexcept
+   : blocked_bloom_filter(std::move(filter)),
+     block_epoch_(std::move(filter.block_epoch_)),
+     epoch_(filter.epoch_)
+   {}
+
+   inline epoch_bloom_filter& operator = (const epoch_bloom_filter& f)
+   {
+      blocked_bloom_filter::operator=(f);
+      block_epoch_ = f.block_epoch_;
+      epoch_ = f.epoch_;
+      return *this;
+   }
+
+   inline epoch_bloom_filter& operator = (epoch_bloom_filter&& f) noexcept
+   {
+      swap(f);
+      return *this;
+   }
+
+   inline void swap(epoch_bloom_filter& f) noexcept
+   {
+      blocked_bloom_filter::swap(f);
+      block_epoch_.swap(f.block_epoch_);
+      std::swap(epoch_,f.epoch_);
+   }
+
+   inline void clear()
+   {
+      if (0 == ++epoch_)
+      {
+         // The epoch wrapped around, old tags could look current again
+         std::fill_n(bit_table_,raw_table_size_,0x00);
+         std::fill(block_epoch_.begin(),block_epoch_.end(),0);
+      }
+      inserted_element_count_ = 0;
+   }
+
+   inline bool clear_step(std::size_t& cursor, const std::size_t)
+   {
+      // Clearing is constant time, there is nothing to spread out
+      if (cursor < raw_table_size_)
+      {
+         clear();
+         cursor = raw_table_size_;
+      }
+      inserted_element_count_ = 0;
+      return true;
+   }
+
+   inline void insert(const key_digest& digest)
+   {
+      unsigned int& block_epoch = block_epoch_[digest.block_offset / cells_per_block];
+      if (epoch_ != block_epoch)
+      {
+         std::fill_n(bit_table_ + digest.block_offset,cells_per_block,0x00);
+         block_epoch = epoch_;
+      }
+      blocked_bloom_filter::insert(digest);
+   }
+
+   inline void insert(const unsigned char* key_begin, const std::size_t& length)
+   {
+      key_digest digest;
+      compute_digest(key_begin,length,digest);
+      insert(digest);
+   }
+
+   template<typename T>
+   inline void insert(const T& t)
+   {
+      // Note: T must be a C++ POD type.
+      insert(reinterpret_cast<const unsigned char*>(&t),sizeof(T));
+   }
+
+   inline void insert(const std::string& key)
+   {
+      insert(reinterpret_cast<const unsigned char*>(key.c_str()),key.size());
+   }
+
+   inline void insert(const char* data, const std::size_t& length)
+   {
+      insert(reinterpret_cast<const unsigned char*>(data),length);
+   }
+
+   inline bool contains(const key_digest& digest) const
+   {
+      if (epoch_ != block_epoch_[digest.block_offset / cells_per_block])
+      {
+         return false;
+      }
+      return blocked_bloom_filter::contains(digest);
+   }
+
+   inline virtual bool contains(const unsigned char* key_begin, const std::size_t length) const
+   {
+      key_digest digest;
+      compute_digest(key_begin,length,digest);
+      return contains(digest);
+   }
+
+   template<typename T>
+   inline bool contains(const T& t) const
+   {
+      return contains(reinterpret_cast<const unsigned char*>(&t),static_cast<std::size_t>(sizeof(T)));
+   }
+
+   inline bool contains(const std::string& key) const
+   {
+      return contains(reinterpret_cast<const unsigned char*>(key.c_str()),key.size());
+   }
+
+   inline bool contains(const char* data, const std::size_t& length) const
+   {
+      return contains(reinterpret_cast<const unsigned char*>(data),length);
+   }
+
+   inline unsigned long long int bit_count() const
+   {
+      // Number of bits set in the blocks of the current epoch
+      unsigned long long int count = 0;
+      for (std::size_t b = 0; b < block_epoch_.size(); ++b)
+      {
+         if (epoch_ != block_epoch_[b])
+            continue;
+         for (std::size_t i = b * cells_per_block; i < (b + 1) * cells_per_block; ++i)
+         {
+            count += __builtin_popcountll(bit_table_[i]);
+         }
+      }
+      return count;
+   }
+
+private:
+
+   static const std::size_t cells_per_block = cache_line_size / sizeof(cell_type);
+
+   bool operator == (const bloom_filter&) const;
+   bool operator != (const bloom_filter&) const;
+   bloom_filter& operator &= (const bloom_filter&);
+   bloom_filter& operator |= (const bloom_filter&);
+   bloom_filter& operator ^= (const bloom_filter&);
+
+   std::vector<unsigned int> block_epoch_;
+   unsigned int epoch_;
+};
+
+inline void swap(epoch_bloom_filter& a, epoch_bloom_filter& b) noexcept
+{
+   a.swap(b);
+}
+
 #endif
 
 
 /*
   Note 1:
-  If it can be guaranteed that bits_per_char will be of the form 2^n then
-  the following optimization can be used:
+  The table is stored as 64 bit cells and bits_per_cell is a power of 2,
+  so the division and modulo in
+
+  bit_table_[bit_index / bits_per_cell] |= (1 << (bit_index % bits_per_cell));
 
-  hash_table[bit_index >> n] |= bit_mask[bit_index & (bits_per_char - 1)];
+  compile down to a shift and a mask. clear, the set operations and
+  bit_count all work a whole cell at a time.
 
   Note 2:
-  For performance reasons where possible when allocating memory it should
-  be aligned (aligned_alloc) according to the architecture being used.
+  Bit tables are aligned to a cache line, so that a block of a
+  blocked_bloom_filter never straddles two lines. Tables of 32MB or more
+  are aligned to a page, so that clear() can decommit them. With one of
+  the huge page modes of bloom_parameters, tables of 2MB or more are
+  aligned to a 2MB huge page and backed by huge pages, which cuts the
+  TLB misses of the random probes into a large table. See
+  allocate_aligned_table.
 */
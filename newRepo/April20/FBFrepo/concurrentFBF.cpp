@@ -0,0 +1,425 @@
+#ifndef CONCURRENT_FBF_CPP
+#define CONCURRENT_FBF_CPP
+
+/*
+ * Header files
+ */
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+/*
+ * Bloom Filter Library
+ */
+#include "bloom_filter.hpp"
+
+/*
+ * Dynamic FBF class, the macros are shared
+ */
+#include "dynFBF.cpp"
+
+/*
+ * Macros
+ */
+#define MIN_NUM_OF_READERS 64
+#define READER_INACTIVE (~0ULL)
+
+using namespace std;
+
+/*
+ * Concurrent FBF class
+ */
+/*******************************************************************
+ *******************************************************************
+ ** CLASS NAME: concurrentFBF (Concurrent Forgetful Bloom Filter)
+ **
+ ** NOTE: This class implements an FBF with a fixed number of
+ **       constituent BFs that many threads can insert into and
+ **       query at once without taking any lock. Inserts set bits
+ **       with an atomic OR on the 64 bit cells of the future and
+ **       present BFs, queries read the cells atomically
+ **
+ ** The ring of constituent BFs is published as an immutable view
+ ** through an atomic pointer. A refresh builds a new view whose
+ ** future BF is a clean table, swaps it in and retires the old
+ ** view and the oldest table. A thread that loaded the old view
+ ** may still be using them, so they are reclaimed with epoch based
+ ** reclamation: every insert or query announces the global epoch
+ ** in the slot of its thread for its duration, and a table retired
+ ** in epoch e is only cleared and reused once every active slot
+ ** announces a later epoch. Refreshes are serialized with each
+ ** other by refreshMtx, which inserts and queries never take
+ **
+ ** Each thread registers once with registerThread() and passes its
+ ** slot to insert() and contains(). There is a slot per hardware
+ ** thread, and at least MIN_NUM_OF_READERS
+ *******************************************************************
+ *******************************************************************/
+class concurrentFBF {
+
+public:
+  /*
+   * A published ring of constituent BFs, gen[g] is generation g
+   * ie gen[0] is the future BF
+   */
+  struct generationView {
+    vector<bloom_filter *> gen;
+  };
+
+  /*
+   * Epoch announced by a thread, READER_INACTIVE outside of an
+   * insert or a query. One cache line per slot so that the
+   * threads do not share lines
+   */
+  struct alignas(64) readerSlot {
+    std::atomic<unsigned long long int> epoch;
+    std::atomic<bool> inUse;
+  };
+
+  /*
+   * Bloom Filter parameters
+   */
+  bloom_parameters parameters;
+
+  /*
+   * Number of constituent BFs, fixed at construction
+   */
+  unsigned int numberOfBFs;
+
+  /*
+   * Every table of the FBF, live, retired or clean. newBF is the
+   * empty table they are copied from, it is also used to hash the
+   * keys as all the tables share its parameters
+   */
+  deque<bloom_filter> tables;
+  bloom_filter newBF;
+
+  /*
+   * Current view of the constituent BFs
+   */
+  std::atomic<generationView *> view;
+
+  /*
+   * Epoch based reclamation state
+   */
+  std::atomic<unsigned long long int> globalEpoch;
+  vector<readerSlot> readers;
+
+  /*
+   * Views and tables retired with the epoch they were retired in
+   * and tables cleared for reuse. Only touched under refreshMtx
+   */
+  vector<pair<unsigned long long int, generationView *> > retiredViews;
+  vector<pair<unsigned long long int, bloom_filter *> > retiredTables;
+  vector<bloom_filter *> cleanTables;
+  std::mutex refreshMtx;
+
+  /************************************************************
+   * FUNCTION NAME: concurrentFBF
+   *
+   * Constructor of the concurrent FBF class
+   *
+   * PARAMETERS:
+   *            numberBFs: gives the number of constituent BFs
+   *                       of the FBF, at least 3
+   *            tableSize: gives the number of bits in each of the
+   *                       constituent BFs in the FBF
+   *            numOfHashes: gives the number of hashes to be used
+   *                         by the constituent BFs in the FBF
+   *
+   * RETURNS: NA
+   ************************************************************/
+  concurrentFBF(unsigned long numberBFs,
+                unsigned long long int tableSize,
+                unsigned int numOfHashes) {
+
+    parameters.projected_element_count = 10000;
+    parameters.false_positive_probability = 0.0001;
+    parameters.random_seed = 0xA5A5A5A5;
+    if ( !parameters ) {
+      cout<<" ERROR :: Invalid set of bloom filter parameters " <<endl;
+    }
+    parameters.compute_optimal_parameters(tableSize, numOfHashes);
+
+    if ( numberBFs < 3 ) {
+      cout<<" ERROR :: An FBF needs at least 3 constituent BFs " <<endl;
+      numberBFs = 3;
+    }
+    numberOfBFs = numberBFs;
+    cout<<" INFO :: NUMBER OF CONSTITUENT BFs initialized in the FBF: " <<numberBFs <<endl;
+
+    newBF = bloom_filter(parameters);
+    generationView *first = new generationView;
+    for ( unsigned int counter = 0; counter < numberOfBFs; counter++ ) {
+      tables.push_back(newBF);
+      first->gen.push_back(&tables.back());
+    }
+    view.store(first);
+
+    globalEpoch.store(0);
+    unsigned int slots = std::thread::hardware_concurrency();
+    if ( slots < MIN_NUM_OF_READERS ) {
+      slots = MIN_NUM_OF_READERS;
+    }
+    readers = vector<readerSlot>(slots);
+    for ( unsigned int slot = 0; slot < readers.size(); slot++ ) {
+      readers[slot].epoch.store(READER_INACTIVE);
+      readers[slot].inUse.store(false);
+    }
+    cout<<" INFO :: READER SLOTS: " <<slots <<endl;
+
+    cout<<" INFO :: Concurrent FBF initialized " <<endl;
+  }
+
+  /************************************************************
+   * FUNCTION NAME: ~concurrentFBF
+   *
+   * Destructor of the concurrent FBF class, no thread may be
+   * using the FBF any more
+   *
+   * RETURNS: NA
+   ************************************************************/
+  ~concurrentFBF() {
+    delete view.load();
+    for ( unsigned int counter = 0; counter < retiredViews.size(); counter++ ) {
+      delete retiredViews[counter].second;
+    }
+  }
+
+  /************************************************************
+   * FUNCTION NAME: registerThread
+   *
+   * This function reserves a reader slot for the calling
+   * thread
+   *
+   * RETURNS: the slot, -1 if all the slots are taken
+   ************************************************************/
+  int registerThread() {
+    for ( unsigned int slot = 0; slot < readers.size(); slot++ ) {
+      bool expected = false;
+      if ( readers[slot].inUse.compare_exchange_strong(expected, true) ) {
+        return slot;
+      }
+    }
+    cout<<" ERROR :: No reader slot left " <<endl;
+    return -1;
+  }
+
+  /************************************************************
+   * FUNCTION NAME: unregisterThread
+   *
+   * This function gives back a slot reserved by registerThread
+   *
+   * PARAMETERS:
+   *            slot: slot of the calling thread
+   *
+   * RETURNS: void
+   ************************************************************/
+  void unregisterThread(int slot) {
+    readers[slot].epoch.store(READER_INACTIVE);
+    readers[slot].inUse.store(false);
+  }
+
+  /************************************************************
+   * FUNCTION NAME: enter
+   *
+   * This function announces the current epoch in a slot and
+   * returns the view to work on. The announcement has to be
+   * visible before the view is loaded, hence sequentially
+   * consistent
+   *
+   * PARAMETERS:
+   *            slot: slot of the calling thread
+   *
+   * RETURNS: the current view
+   ************************************************************/
+  generationView *enter(int slot) {
+    readers[slot].epoch.store(globalEpoch.load());
+    return view.load();
+  }
+
+  /************************************************************
+   * FUNCTION NAME: leave
+   *
+   * This function ends the use of the view returned by enter
+   *
+   * PARAMETERS:
+   *            slot: slot of the calling thread
+   *
+   * RETURNS: void
+   ************************************************************/
+  void leave(int slot) {
+    readers[slot].epoch.store(READER_INACTIVE, std::memory_order_release);
+  }
+
+  /************************************************************
+   * FUNCTION NAME: insert
+   *
+   * This function inserts into the present and future BFs, it
+   * never blocks
+   *
+   * PARAMETERS:
+   *            slot: slot of the calling thread
+   *            element: element to be inserted into the FBF
+   *
+   * RETURNS: void
+   ************************************************************/
+  void insert(int slot, unsigned long long int element) {
+    bloom_filter::key_digest digest;
+    newBF.compute_digest(element, digest);
+    generationView *current = enter(slot);
+    current->gen[DFUTURE]->insert_atomic(digest);
+    current->gen[DFUTURE + 1]->insert_atomic(digest);
+    leave(slot);
+  }
+
+  /************************************************************
+   * FUNCTION NAME: contains
+   *
+   * This function checks the membership of an element using
+   * SMART RULES as dynFBF::contains does, it never blocks
+   *
+   * PARAMETERS:
+   *            slot: slot of the calling thread
+   *            element: element to be looked up in the FBF
+   *
+   * RETURNS: (int) NOT_IN_FBF if the element is absent, else its
+   *          age bucket as in dynFBF::contains
+   ************************************************************/
+  int contains(int slot, unsigned long long int element) {
+    bloom_filter::key_digest digest;
+    newBF.compute_digest(element, digest);
+    generationView *active = enter(slot);
+    int age = NOT_IN_FBF;
+    bool previous = active->gen[DFUTURE]->contains_atomic(digest);
+    bool current = false;
+    for ( unsigned int g = DFUTURE + 1; g < numberOfBFs; g++ ) {
+      current = active->gen[g]->contains_atomic(digest);
+      if ( previous && current ) {
+        age = g - 1;
+        break;
+      }
+      previous = current;
+    }
+    if ( NOT_IN_FBF == age && current ) {
+      age = numberOfBFs - 1;
+    }
+    leave(slot);
+    return age;
+  }
+
+  /************************************************************
+   * FUNCTION NAME: refresh
+   *
+   * This function publishes a new view in which every
+   * generation has aged by one and the future BF is a clean
+   * table. Inserts and queries still on the old view carry on
+   * with it
+   *
+   * RETURNS: void
+   ************************************************************/
+  void refresh() {
+    std::lock_guard<std::mutex> guard(refreshMtx);
+    reclaim();
+
+    bloom_filter *future = NULL;
+    if ( !cleanTables.empty() ) {
+      future = cleanTables.back();
+      cleanTables.pop_back();
+    }
+    else {
+      tables.push_back(newBF);
+      future = &tables.back();
+    }
+
+    generationView *current = view.load();
+    generationView *next = new generationView;
+    next->gen.push_back(future);
+    for ( unsigned int g = DFUTURE; g < numberOfBFs - 1; g++ ) {
+      next->gen.push_back(current->gen[g]);
+    }
+    view.store(next);
+
+    // Threads announcing this epoch or an earlier one may hold
+    // the old view
+    unsigned long long int retiredEpoch = globalEpoch.fetch_add(1);
+    retiredViews.push_back(make_pair(retiredEpoch, current));
+    retiredTables.push_back(make_pair(retiredEpoch, current->gen[numberOfBFs - 1]));
+  }
+
+  /************************************************************
+   * FUNCTION NAME: reclaim
+   *
+   * This function frees the retired views and clears the
+   * retired tables that no thread can be using any more.
+   * Called under refreshMtx
+   *
+   * RETURNS: void
+   ************************************************************/
+  void reclaim() {
+    unsigned long long int oldest = READER_INACTIVE;
+    for ( unsigned int slot = 0; slot < readers.size(); slot++ ) {
+      unsigned long long int announced = readers[slot].epoch.load();
+      if ( announced < oldest ) {
+        oldest = announced;
+      }
+    }
+
+    unsigned int kept = 0;
+    for ( unsigned int counter = 0; counter < retiredViews.size(); counter++ ) {
+      if ( retiredViews[counter].first < oldest ) {
+        delete retiredViews[counter].second;
+      }
+      else {
+        retiredViews[kept++] = retiredViews[counter];
+      }
+    }
+    retiredViews.resize(kept);
+
+    kept = 0;
+    for ( unsigned int counter = 0; counter < retiredTables.size(); counter++ ) {
+      if ( retiredTables[counter].first < oldest ) {
+        retiredTables[counter].second->clear();
+        cleanTables.push_back(retiredTables[counter].second);
+      }
+      else {
+        retiredTables[kept++] = retiredTables[counter];
+      }
+    }
+    retiredTables.resize(kept);
+  }
+
+  /*************************************************************
+   * FUNCTION NAME: retNumOfBFs
+   *
+   * This function return the number of constituent BFs in the
+   * FBF
+   *
+   * RETURN: number of constituent BFs
+   *************************************************************/
+  unsigned int retNumOfBFs() {
+    return numberOfBFs;
+  }
+
+  /*************************************************************
+   * FUNCTION NAME: retNumOfTables
+   *
+   * This function returns the number of tables allocated, the
+   * constituent BFs plus the retired and clean ones
+   *
+   * RETURN: number of tables
+   *************************************************************/
+  unsigned int retNumOfTables() {
+    return tables.size();
+  }
+
+}; // End of concurrentFBF class
+
+#endif
+
+/*
+ * EOF
+ */
@@ -0,0 +1,314 @@
+#ifndef DELTA_FBF_CPP
+#define DELTA_FBF_CPP
+
+/*
+ * Header files
+ */
+#include <iostream>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+/*
+ * Bloom Filter Library
+ */
+#include "bloom_filter.hpp"
+
+/*
+ * Dynamic FBF class
+ */
+#include "dynFBF.cpp"
+
+/*
+ * Macros
+ */
+#define DEF_DELTA_MERGE_OPS 65536
+#define MAX_NUM_OF_WRITERS 64
+
+using namespace std;
+
+/*
+ * Delta FBF class
+ */
+/*******************************************************************
+ *******************************************************************
+ ** CLASS NAME: deltaFBF (Forgetful Bloom Filter with writer deltas)
+ **
+ ** NOTE: This class puts a shared dynFBF behind one mutex, but its
+ **       writers take no lock on an insert. Each writer inserts into
+ **       a private delta BF and ORs it into the shared generations
+ **       every mergeOps inserts, taking the mutex only then
+ **
+ ** An insert goes to the future and the present BF alike, so one
+ ** delta serves both and a merge ORs it into the two of them. A
+ ** refresh merges the delta of every writer before it ages the
+ ** generations, so a delta always belongs to the current future and
+ ** present BFs. The shared FBF is used without its summary BFs
+ **
+ ** A refresh also has to merge the deltas of idle writers. An insert
+ ** raises the writing flag of its writer for its duration and a
+ ** refresh raises the mergeRequested flag of a writer, then waits for
+ ** the insert in progress if any. Both flags are sequentially
+ ** consistent, so at least one side sees the other and an insert
+ ** that sees the request steps aside until the merge is done. An
+ ** insert thus costs an atomic store and load instead of a lock
+ **
+ ** Queries only look at the shared generations, so an insert may be
+ ** missed until it is merged, ie for at most mergeOps inserts of its
+ ** writer or until the next refresh or flush(). Each writer holds
+ ** one table of the size of a constituent BF, and refresh() ORs up
+ ** to MAX_NUM_OF_WRITERS of them into the shared FBF under
+ ** sharedMtx, so every query waits for the whole refresh
+ *******************************************************************
+ *******************************************************************/
+class deltaFBF {
+
+public:
+  /*
+   * State of a writer. Its delta and insert count belong to its
+   * insert while writing is set and to a merge while
+   * mergeRequested is set, see the class NOTE. Aligned so that
+   * two writers never share a line
+   */
+  struct alignas(64) writerDelta {
+    bloom_filter delta;
+    unsigned long long int pending;
+    std::atomic<bool> writing;
+    std::atomic<bool> mergeRequested;
+    bool inUse;
+  };
+
+  /*
+   * Shared FBF and its lock, taken by merges, refreshes and
+   * queries
+   */
+  dynFBF shared;
+  std::mutex sharedMtx;
+
+  /*
+   * Writer slots, taken and given back under sharedMtx. The
+   * delta of a slot is allocated by its first writer
+   */
+  writerDelta writers[MAX_NUM_OF_WRITERS];
+
+  /*
+   * Inserts of a writer between two merges
+   */
+  unsigned long long int mergeOps;
+
+  /*
+   * Number of merges so far
+   */
+  unsigned long long int mergeCount;
+
+  /************************************************************
+   * FUNCTION NAME: deltaFBF
+   *
+   * Constructor of the delta FBF class
+   *
+   * PARAMETERS:
+   *            numberBFs: number of constituent BFs of the FBF
+   *            tableSize: number of bits in each constituent BF
+   *            numOfHashes: number of hashes of the constituent
+   *                         BFs
+   *            ops: inserts of a writer between two merges
+   *
+   * RETURNS: NA
+   ************************************************************/
+  deltaFBF(unsigned long numberBFs,
+           unsigned long long int tableSize,
+           unsigned int numOfHashes,
+           unsigned long long int ops = DEF_DELTA_MERGE_OPS)
+  : shared(numberBFs, tableSize, numOfHashes) {
+    for ( unsigned int slot = 0; slot < MAX_NUM_OF_WRITERS; slot++ ) {
+      writers[slot].writing.store(false);
+      writers[slot].mergeRequested.store(false);
+      writers[slot].inUse = false;
+    }
+    mergeOps = ( 0 == ops ) ? 1 : ops;
+    mergeCount = 0;
+    cout<<" INFO :: DELTA MERGE OPS: " <<mergeOps <<endl;
+  }
+
+  /************************************************************
+   * FUNCTION NAME: registerWriter
+   *
+   * This function gives the calling thread a writer slot with
+   * an empty delta
+   *
+   * RETURNS: the slot, -1 if all MAX_NUM_OF_WRITERS slots are
+   *          taken
+   ************************************************************/
+  int registerWriter() {
+    std::lock_guard<std::mutex> guard(sharedMtx);
+    unsigned int slot = 0;
+    while ( slot < MAX_NUM_OF_WRITERS && writers[slot].inUse ) {
+      slot++;
+    }
+    if ( MAX_NUM_OF_WRITERS == slot ) {
+      cout<<" ERROR :: No writer slot left " <<endl;
+      return -1;
+    }
+    if ( 0 == writers[slot].delta.size() ) {
+      writers[slot].delta = bloom_filter(shared.parameters);
+    }
+    writers[slot].pending = 0;
+    writers[slot].inUse = true;
+    return slot;
+  }
+
+  /************************************************************
+   * FUNCTION NAME: unregisterWriter
+   *
+   * This function merges the delta of a writer and gives its
+   * slot back
+   *
+   * PARAMETERS:
+   *            slot: slot of the calling thread
+   *
+   * RETURNS: void
+   ************************************************************/
+  void unregisterWriter(int slot) {
+    std::lock_guard<std::mutex> guard(sharedMtx);
+    mergeLocked(writers[slot]);
+    writers[slot].inUse = false;
+  }
+
+  /************************************************************
+   * FUNCTION NAME: insert
+   *
+   * This function inserts into the delta of the calling
+   * writer without taking a lock. It only takes the shared lock
+   * to merge, every mergeOps inserts
+   *
+   * PARAMETERS:
+   *            slot: slot of the calling thread
+   *            element: element to be inserted into the FBF
+   *
+   * RETURNS: void
+   ************************************************************/
+  void insert(int slot, unsigned long long int element) {
+    writerDelta &writer = writers[slot];
+    writer.writing.store(true);
+    while ( writer.mergeRequested.load() ) {
+      // A refresh is merging the delta, step aside until it is done
+      writer.writing.store(false, std::memory_order_release);
+      while ( writer.mergeRequested.load(std::memory_order_acquire) ) {
+        std::this_thread::yield();
+      }
+      writer.writing.store(true);
+    }
+    writer.delta.insert(element);
+    writer.pending++;
+    const bool full = ( writer.pending >= mergeOps );
+    writer.writing.store(false, std::memory_order_release);
+
+    if ( full ) {
+      flush(slot);
+    }
+  }
+
+  /************************************************************
+   * FUNCTION NAME: flush
+   *
+   * This function merges the delta of the calling writer so
+   * that the queries see all its inserts. Only the writer calls
+   * it, so it needs no flag to keep its inserts away
+   *
+   * PARAMETERS:
+   *            slot: slot of the calling thread
+   *
+   * RETURNS: void
+   ************************************************************/
+  void flush(int slot) {
+    std::lock_guard<std::mutex> guard(sharedMtx);
+    mergeLocked(writers[slot]);
+  }
+
+  /************************************************************
+   * FUNCTION NAME: mergeLocked
+   *
+   * This function ORs the delta of a writer into the shared
+   * future and present BFs, adds its inserts to their element
+   * counts and empties it. Called under sharedMtx, by the
+   * writer itself or by a refresh holding its mergeRequested
+   *
+   * PARAMETERS:
+   *            writer: writer to be merged
+   *
+   * RETURNS: void
+   ************************************************************/
+  void mergeLocked(writerDelta &writer) {
+    if ( 0 == writer.pending ) {
+      return;
+    }
+    shared.generation(shared.dfuture) |= writer.delta;
+    shared.generation(shared.dpresent) |= writer.delta;
+    shared.generation(shared.dfuture).add_element_count(writer.pending);
+    shared.generation(shared.dpresent).add_element_count(writer.pending);
+    writer.delta.clear();
+    writer.pending = 0;
+    mergeCount++;
+  }
+
+  /************************************************************
+   * FUNCTION NAME: contains
+   *
+   * This function checks the membership of an element in the
+   * shared generations using SMART RULES
+   *
+   * PARAMETERS:
+   *            element: element to be looked up in the FBF
+   *
+   * RETURNS: (int) NOT_IN_FBF or the age bucket of the element,
+   *          see dynFBF::contains
+   ************************************************************/
+  int contains(unsigned long long int element) {
+    std::lock_guard<std::mutex> guard(sharedMtx);
+    return shared.contains(element);
+  }
+
+  /************************************************************
+   * FUNCTION NAME: refresh
+   *
+   * This function merges the delta of every writer and then
+   * refreshes the shared FBF. An insert in progress is waited
+   * for, the next inserts of the writer wait for its merge
+   *
+   * RETURNS: void
+   ************************************************************/
+  void refresh() {
+    std::lock_guard<std::mutex> guard(sharedMtx);
+    for ( unsigned int slot = 0; slot < MAX_NUM_OF_WRITERS; slot++ ) {
+      writerDelta &writer = writers[slot];
+      if ( !writer.inUse ) {
+        continue;
+      }
+      writer.mergeRequested.store(true);
+      while ( writer.writing.load() ) {
+        std::this_thread::yield();
+      }
+      mergeLocked(writer);
+      writer.mergeRequested.store(false, std::memory_order_release);
+    }
+    shared.refresh();
+  }
+
+  /*************************************************************
+   * FUNCTION NAME: retMergeCount
+   *
+   * This function returns the number of merges so far
+   *
+   * RETURN: number of merges
+   *************************************************************/
+  unsigned long long int retMergeCount() {
+    return mergeCount;
+  }
+
+}; // End of deltaFBF class
+
+#endif
+
+/*
+ * EOF
+ */
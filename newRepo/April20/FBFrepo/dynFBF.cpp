@@ -1,8 +1,16 @@
+#ifndef DYN_FBF_CPP
+#define DYN_FBF_CPP
+
 /*
  * Header files
  */
 #include <iostream>
 #include <unistd.h>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 /*
  * Bloom Filter Library
@@ -12,21 +20,18 @@
 /*
  * Macros
  */
-#define DEF_NUM_OF_BFS 300
 #define DFUTURE 0
 #define MUL_INC_BFS 2
 #define ADD_DEC_BFS 1
 #define FALSE 0
 #define TRUE 1
-
-/* 
- * Global variables
- */ 
-unsigned int dfuture = DFUTURE;
-unsigned int dpresent = DFUTURE + 1;
-unsigned int pastStart = DFUTURE + 2;
-unsigned int numberOfBFs;
-unsigned int pastEnd;
+#define NOT_IN_FBF -1
+#define MAX_NUM_OF_SPARES 4
+#define SPARE_CLEAN 0
+#define SPARE_DIRTY 1
+#define SPARE_CLEARING 2
+#define DEF_POOL_HIGH_WATER 4
+#define SUMMARY_CLEAR_LINES 1
 
 using namespace std;
 
@@ -35,7 +40,7 @@ using namespace std;
  */
 /*******************************************************************
  *******************************************************************
- ** CLASS NAME: dynFBF (Forgetful Bloom Filter)
+ ** CLASS NAME: basicDynFBF (Forgetful Bloom Filter)
  **
  ** NOTE: This class implements the dynamic FBF ie it contains the 
  **       minimum THREE constituent bloom filters (BF) namely:
@@ -46,9 +51,15 @@ using namespace std;
  **       the load increases
  **
  ** The class is mainly used to compare to run dynamic resizing tests 
+ **
+ ** The constituent BF type is a template parameter so that the 
+ ** classic bloom_filter, the cache line blocked_bloom_filter and the
+ ** epoch tagged epoch_bloom_filter can be used, see the typedefs 
+ ** below
  *******************************************************************
  *******************************************************************/
-class dynFBF { 
+template <typename constituent_bf>
+class basicDynFBF { 
 
 public:
   /* 
@@ -56,21 +67,123 @@ public:
    */
   bloom_parameters parameters;
 
+  /*
+   * Slab arena holding the tables of the constituent BFs, newBF,
+   * the spares and the pooled BFs, declared before them so that
+   * it outlives them. Adjacent generations are one slot apart
+   * and a resize only adds a slab when every slot is taken
+   */
+  table_arena arena;
+
   /* 
    * Constituent BFs of the FBF
    * Past, Present and Future BFs
-   * The vector can accommodate multiple past BFs as well
+   * The deque can accommodate multiple past BFs as well, it only
+   * holds the live constituent BFs and grows in chunks without 
+   * moving the existing ones
    */
-  bloom_filter dyn_fbf[DEF_NUM_OF_BFS];
+  deque<constituent_bf> dyn_fbf;
 
   /* 
    * New BF to create a new future BF 
    * after each refresh time
    */
-  bloom_filter newBF;
+  constituent_bf newBF;
+
+  /*
+   * Physical slot in dyn_fbf holding the future BF. The 
+   * constituent BFs form a logical ring, generation g lives in
+   * slot (head + g) % numberOfBFs, so a refresh only has to 
+   * move head back by one and recycle the oldest BF
+   */
+  unsigned int head;
+
+  /*
+   * Logical generations of the future, present and first past BF,
+   * the number of constituent BFs and the oldest past BF. They are
+   * per instance so that many FBFs can live in one process
+   */
+  unsigned int dfuture;
+  unsigned int dpresent;
+  unsigned int pastStart;
+  unsigned int numberOfBFs;
+  unsigned int pastEnd;
+
+  /*
+   * Optional summary BFs holding every element inserted during a
+   * window of numberOfBFs refreshes, summaryCurrent being the one
+   * inserted into. An element lives in the FBF for numberOfBFs 
+   * refreshes, so together they hold every element of the FBF and
+   * an element missing from both is absent from the FBF. They are
+   * sized for all the elements of the FBF, unlike a union of the
+   * constituent BFs which would saturate as numberOfBFs grows. A
+   * resizing only changes the size of the summaries opened after
+   * it, summarySizesDiffer is set until both have been replaced
+   */
+  constituent_bf summary[2];
+  unsigned int summaryCurrent;
+  bool summaryEnabled;
+  bool summarySizesDiffer;
+
+  /*
+   * Pre-zeroed summary BF swapped in when a window opens, so that
+   * no summary is zeroed on the refresh path. The expired summary
+   * takes its place and every insert zeroes SUMMARY_CLEAR_LINES
+   * cache lines of it from summaryClearCursor on. summaryTableSize
+   * is the size of a summary for the current numberOfBFs
+   */
+  constituent_bf summarySpare;
+  size_t summaryClearCursor;
+  unsigned long long int summaryTableSize;
+
+  /*
+   * Number of refreshes so far, the refresh that opened the window
+   * of summaryCurrent and the first refresh from which the
+   * summaries hold every element of the FBF
+   */
+  unsigned long long int epoch;
+  unsigned long long int windowStart;
+  unsigned long long int summaryUsableFrom;
+
+  /*
+   * Optional pre-zeroed spare BFs. At refresh a clean spare is 
+   * swapped in as the new future BF and the retired BF is handed
+   * to the clearer thread, so no table is zeroed on the refresh
+   * path. spareState is guarded by spareMtx, a spare is only
+   * touched by the clearer thread while SPARE_CLEARING
+   */
+  constituent_bf spareBF[MAX_NUM_OF_SPARES];
+  int spareState[MAX_NUM_OF_SPARES];
+  unsigned int numberOfSpares;
+  bool stopClearer;
+  std::thread clearer;
+  std::mutex spareMtx;
+  std::condition_variable spareCv;
+
+  /*
+   * Optional incremental clearing without threads. clearingBF is
+   * the next future BF, each insert zeroes cellsPerInsert more 
+   * cells of it from clearCursor on. insertClearedCells and
+   * refreshClearedCells count the cells zeroed on each path
+   */
+  constituent_bf clearingBF;
+  size_t clearCursor;
+  size_t cellsPerInsert;
+  unsigned long long int insertClearedCells;
+  unsigned long long int refreshClearedCells;
+
+  /*
+   * Constituent BFs dropped by triggerTrimDown, kept for the next
+   * triggerDynamicResizing instead of allocating new tables. At most
+   * poolHighWater BFs are kept, the rest are freed. A pooled BF is
+   * cleared when it enters the pool so that large tables give their
+   * pages back to the OS while keeping their address space
+   */
+  vector<constituent_bf> generationPool;
+  unsigned int poolHighWater;
 
   /************************************************************ 
-   * FUNCTION NAME: dynFBF 
+   * FUNCTION NAME: basicDynFBF 
    *
    * Constructor of the FBF class
    * 
@@ -84,7 +197,7 @@ public:
    * 
    * RETURNS: NA 
    ************************************************************/
-  dynFBF(unsigned long numberBFs, 
+  basicDynFBF(unsigned long numberBFs, 
          unsigned long long int tableSize, 
          unsigned int numOfHashes) { 
 
@@ -96,18 +209,41 @@ public:
     }
     parameters.compute_optimal_parameters(tableSize, numOfHashes);
 
-    bloom_filter baseBF(parameters);
+    // One slot per constituent BF plus newBF, the spares and
+    // the BF cleared by the inserts
+    arena.reserve(numberBFs + MAX_NUM_OF_SPARES + 2);
+    constituent_bf baseBF(parameters, &arena);
     cout<<" INFO :: NUMBER OF CONSTITUENT BFs initialized in the FBF: " <<numberBFs <<endl;
 
+    dyn_fbf.resize(numberBFs);
     for ( unsigned int counter = 0; counter < numberBFs; counter++ ) { 
       dyn_fbf[counter] = baseBF;
       dyn_fbf[counter].clear();
     }
     newBF = baseBF;
+    summaryCurrent = 0;
+    summaryEnabled = false;
+    summarySizesDiffer = false;
+    epoch = 0;
+    windowStart = 0;
+    summaryUsableFrom = 0;
+    summaryClearCursor = 0;
+    summaryTableSize = 0;
+    numberOfSpares = 0;
+    stopClearer = false;
+    clearCursor = 0;
+    cellsPerInsert = 0;
+    insertClearedCells = 0;
+    refreshClearedCells = 0;
+    poolHighWater = DEF_POOL_HIGH_WATER;
 
     // Update the class members
+    dfuture = DFUTURE;
+    dpresent = DFUTURE + 1;
+    pastStart = DFUTURE + 2;
     numberOfBFs = numberBFs;
     pastEnd = numberBFs - 1;
+    head = 0;
 
     cout<<" INFO :: dfuture: " <<dfuture <<endl;
     cout<<" INFO :: dpresent: " <<dpresent <<endl;
@@ -124,25 +260,369 @@ public:
    *
    * RETURNS: NA
    ************************************************************/
-  ~dynFBF() {}
+  ~basicDynFBF() {
+    disableBackgroundClearing();
+  }
+
+  /************************************************************
+   * FUNCTION NAME: generation
+   *
+   * This function maps a logical generation (dfuture, dpresent,
+   * pastStart ... pastEnd) to its constituent BF in the ring
+   *
+   * PARAMETERS:
+   *            g: logical generation, 0 <= g < numberOfBFs
+   *
+   * RETURNS: (constituent_bf &) constituent BF of generation g
+   ************************************************************/
+  inline constituent_bf& generation(unsigned int g) {
+    unsigned int slot = head + g;
+    if ( slot >= numberOfBFs ) {
+      slot -= numberOfBFs;
+    }
+    return dyn_fbf[slot];
+  }
+
+  /************************************************************
+   * FUNCTION NAME: unrollRing
+   *
+   * This function lays the ring out again so that generation g
+   * lives in slot g. Needed before numberOfBFs changes as the
+   * ring mapping depends on it
+   * NOTE: The constituent BFs are swapped, not copied, so only 
+   *       their table pointers move
+   *
+   * RETURNS: void
+   ************************************************************/
+  void unrollRing() {
+    if ( 0 == head ) {
+      return;
+    }
+
+    std::rotate(dyn_fbf.begin(), dyn_fbf.begin() + head, dyn_fbf.begin() + numberOfBFs);
+
+    head = 0;
+  }
+
+  /************************************************************
+   * FUNCTION NAME: enableSummary
+   *
+   * This function turns the summary BFs on or off
+   * NOTE: The summaries cost one more probe set per insert and 
+   *       one and a half times the memory of the constituent BFs,
+   *       counting the spare summary. They can not be 
+   *       built from the constituent BFs, so they only answer 
+   *       lookups once the elements inserted before they were 
+   *       enabled have expired ie after numberOfBFs refreshes
+   *
+   * PARAMETERS:
+   *            enable: TRUE to maintain and use the summary BFs
+   *
+   * RETURNS: void
+   ************************************************************/
+  void enableSummary(bool enable) {
+    summaryEnabled = enable;
+    if ( summaryEnabled ) {
+      resetSummary();
+    }
+  }
+
+  /************************************************************
+   * FUNCTION NAME: resetSummary
+   *
+   * This function creates empty summary BFs and a clean spare
+   * sized for the current number of constituent BFs
+   *
+   * RETURNS: void
+   ************************************************************/
+  void resetSummary() {
+    for ( unsigned int counter = 0; counter < 2; counter++ ) {
+      newSummarySpare();
+      summary[counter].swap(summarySpare);
+    }
+    newSummarySpare();
+    summarySizesDiffer = false;
+    summaryCurrent = 0;
+    windowStart = epoch;
+    summaryUsableFrom = epoch + numberOfBFs;
+  }
+
+  /************************************************************
+   * FUNCTION NAME: newSummarySpare
+   *
+   * This function replaces the spare summary by a clean one
+   * sized for the current number of constituent BFs
+   *
+   * RETURNS: void
+   ************************************************************/
+  void newSummarySpare() {
+    bloom_parameters summaryParameters = parameters;
+    unsigned int numberOfWindows = ( numberOfBFs > 2 ) ? (numberOfBFs / 2) : 1;
+
+    // A constituent BF holds the elements of two refresh periods
+    summaryParameters.optimal_parameters.table_size = generation(dfuture).size() * numberOfWindows;
+    summarySpare = constituent_bf(summaryParameters);
+    summaryClearCursor = 0;
+    summarySpare.clear_step(summaryClearCursor, summarySpare.size());
+    summaryTableSize = summarySpare.size();
+  }
+
+  /************************************************************
+   * FUNCTION NAME: summaryContains
+   *
+   * This function checks the summary BFs for an element and
+   * hands back its digest in the constituent BFs. The element is
+   * hashed once, the digest is mapped onto the other BFs as they
+   * only differ in size
+   *
+   * PARAMETERS:
+   *            element: element to be looked up
+   *            digest: digest of the element in the constituent
+   *                    BFs, only set if TRUE is returned
+   *
+   * RETURNS: (bool) FALSE only if the element is surely absent
+   *          from the FBF
+   ************************************************************/
+  inline bool summaryContains(unsigned long long int element,
+                              typename constituent_bf::key_digest &digest) {
+    if ( !summaryEnabled || epoch < summaryUsableFrom ) {
+      generation(dpresent).compute_digest(element, digest);
+      return true;
+    }
+
+    typename constituent_bf::key_digest summaryDigest;
+    summary[0].compute_digest(element, summaryDigest);
+    if ( !summary[0].contains(summaryDigest) ) {
+      // Unless a resizing is being aged out the digest is shared
+      if ( summarySizesDiffer ) {
+        summary[1].rebase_digest(summaryDigest, digest);
+        if ( !summary[1].contains(digest) ) {
+          return false;
+        }
+      }
+      else if ( !summary[1].contains(summaryDigest) ) {
+        return false;
+      }
+    }
+    generation(dpresent).rebase_digest(summaryDigest, digest);
+    return true;
+  }
+
+  /************************************************************
+   * FUNCTION NAME: swapInSummarySpare
+   *
+   * This function opens a new summary window with the spare
+   * summary, finishing its clear first if the inserts did not.
+   * The expired summary becomes the spare and is cleared by the
+   * next inserts, or replaced if it was sized before a resizing
+   *
+   * RETURNS: void
+   ************************************************************/
+  void swapInSummarySpare() {
+    summarySpare.clear_step(summaryClearCursor, summarySpare.size());
+    summary[summaryCurrent].swap(summarySpare);
+    summaryClearCursor = 0;
+    if ( summarySpare.size() != summaryTableSize ) {
+      newSummarySpare();
+    }
+    summarySizesDiffer = ( summary[0].size() != summary[1].size() );
+  }
+
+  /************************************************************
+   * FUNCTION NAME: enableBackgroundClearing
+   *
+   * This function creates the pre-zeroed spare BFs and starts 
+   * the clearer thread that re-zeroes the retired BFs
+   *
+   * PARAMETERS:
+   *            spares: number of spare BFs, at most 
+   *                    MAX_NUM_OF_SPARES. One is enough unless 
+   *                    refreshes come faster than a table clear
+   *
+   * RETURNS: void
+   ************************************************************/
+  void enableBackgroundClearing(unsigned int spares) {
+    if ( 0 != numberOfSpares ) {
+      return;
+    }
+    if ( spares > MAX_NUM_OF_SPARES ) {
+      spares = MAX_NUM_OF_SPARES;
+    }
+
+    for ( unsigned int counter = 0; counter < spares; counter++ ) {
+      spareBF[counter] = newBF;
+      spareBF[counter].clear();
+      spareState[counter] = SPARE_CLEAN;
+    }
+    numberOfSpares = spares;
+    stopClearer = false;
+    clearer = std::thread(&basicDynFBF::clearerFunc, this);
+  }
+
+  /************************************************************
+   * FUNCTION NAME: disableBackgroundClearing
+   *
+   * This function stops and joins the clearer thread, refresh
+   * clears the recycled BF itself again afterwards
+   *
+   * RETURNS: void
+   ************************************************************/
+  void disableBackgroundClearing() {
+    if ( 0 == numberOfSpares ) {
+      return;
+    }
+
+    spareMtx.lock();
+    stopClearer = true;
+    spareMtx.unlock();
+    spareCv.notify_one();
+    clearer.join();
+    numberOfSpares = 0;
+  }
+
+  /************************************************************
+   * FUNCTION NAME: clearerFunc
+   *
+   * This function is the driver function of the clearer thread.
+   * It zeroes the dirty spare BFs one at a time, outside of the
+   * lock so that refresh never waits for a clear
+   *
+   * RETURNS: void
+   ************************************************************/
+  void clearerFunc() {
+    std::unique_lock<std::mutex> lock(spareMtx);
+    while ( !stopClearer ) {
+      unsigned int counter = 0;
+      while ( counter < numberOfSpares && SPARE_DIRTY != spareState[counter] ) {
+        counter++;
+      }
+      if ( counter == numberOfSpares ) {
+        spareCv.wait(lock);
+        continue;
+      }
+
+      spareState[counter] = SPARE_CLEARING;
+      lock.unlock();
+      spareBF[counter].clear();
+      lock.lock();
+      spareState[counter] = SPARE_CLEAN;
+    }
+  }
+
+  /************************************************************
+   * FUNCTION NAME: swapInSpare
+   *
+   * This function swaps a clean spare BF with the retired BF
+   * and hands the retired BF to the clearer thread
+   *
+   * PARAMETERS:
+   *            retired: BF to be recycled as the new future BF
+   *
+   * RETURNS: (bool) FALSE if no clean spare was available
+   ************************************************************/
+  bool swapInSpare(constituent_bf &retired) {
+    if ( 0 == numberOfSpares ) {
+      return false;
+    }
+
+    spareMtx.lock();
+    unsigned int counter = 0;
+    while ( counter < numberOfSpares && SPARE_CLEAN != spareState[counter] ) {
+      counter++;
+    }
+    if ( counter == numberOfSpares ) {
+      spareMtx.unlock();
+      return false;
+    }
+    retired.swap(spareBF[counter]);
+    spareState[counter] = SPARE_DIRTY;
+    spareMtx.unlock();
+    spareCv.notify_one();
+
+    return true;
+  }
+
+  /************************************************************
+   * FUNCTION NAME: enableIncrementalClearing
+   *
+   * This function spreads the clearing of the next future BF
+   * over the inserts, for builds that can not run the clearer
+   * thread. The extra cost of an insert is bounded by zeroing
+   * linesPerInsert cache lines
+   * NOTE: The table is clean in time for the next refresh if
+   *       linesPerInsert * inserts per refresh period covers the
+   *       table, otherwise refresh zeroes what is left
+   *
+   * PARAMETERS:
+   *            linesPerInsert: cache lines zeroed by each insert,
+   *                            0 turns incremental clearing off
+   *
+   * RETURNS: void
+   ************************************************************/
+  void enableIncrementalClearing(unsigned int linesPerInsert) {
+    cellsPerInsert = linesPerInsert * (cache_line_size / sizeof(unsigned long long int));
+    if ( 0 != cellsPerInsert ) {
+      clearingBF = newBF;
+      clearCursor = 0;
+      clearingBF.clear_step(clearCursor, clearingBF.size());
+    }
+  }
+
+  /************************************************************
+   * FUNCTION NAME: swapInCleared
+   *
+   * This function swaps the incrementally cleared BF with the
+   * retired BF, finishing its clear first if the inserts did 
+   * not. The retired BF is cleared by the next inserts
+   *
+   * PARAMETERS:
+   *            retired: BF to be recycled as the new future BF
+   *
+   * RETURNS: (bool) FALSE if incremental clearing is off
+   ************************************************************/
+  bool swapInCleared(constituent_bf &retired) {
+    if ( 0 == cellsPerInsert ) {
+      return false;
+    }
+
+    size_t cursor = clearCursor;
+    clearingBF.clear_step(clearCursor, clearingBF.size());
+    refreshClearedCells += clearCursor - cursor;
+
+    retired.swap(clearingBF);
+    clearCursor = 0;
+
+    return true;
+  }
 
   /************************************************************
    * FUNCTION NAME: refresh
    * 
    * This function refreshes the FBF
+   * NOTE: The oldest BF is recycled as the new future BF by 
+   *       moving the head of the ring, no BF is copied. With 
+   *       background clearing it is swapped for a clean spare 
+   *       instead of being cleared here, unless the clearer 
+   *       thread has fallen behind. With incremental clearing 
+   *       it is swapped for the BF cleared by the inserts. The
+   *       expired summary BF is likewise swapped for a spare
    * 
    * RETURNS: void 
    ************************************************************/
   void refresh() { 
 
-    unsigned int j;
-    for ( j = (numberOfBFs - 1); j > 0; j-- ) {
-      dyn_fbf[j].clear();
-      dyn_fbf[j] = dyn_fbf[j - 1];
+    head = ( 0 == head ) ? (numberOfBFs - 1) : (head - 1);
+    if ( !swapInSpare(dyn_fbf[head]) && !swapInCleared(dyn_fbf[head]) ) {
+      dyn_fbf[head].clear();
     }
 
-    dyn_fbf[j].clear();
-    dyn_fbf[j] = newBF;
+    // Elements of the other window have all expired now
+    epoch++;
+    if ( summaryEnabled && (epoch - windowStart) >= numberOfBFs ) {
+      summaryCurrent ^= 1;
+      swapInSummarySpare();
+      windowStart = epoch;
+    }
 
     cout<<endl<<endl<<endl<<endl <<" INFO :: Refreshed FBF" <<endl<<endl<<endl<<endl;
   }
@@ -155,6 +635,11 @@ public:
    *       inserted into the following constituent BFs:
    *       i) present BF
    *       ii) future BF
+   *       The key is hashed once into a digest which is then 
+   *       applied to both BFs. This is valid since all the 
+   *       constituent BFs share the same bloom_parameters. The
+   *       summary BF only differs in size, so the digest is
+   *       rebased onto it rather than computed again
    *
    * PARAMETERS: 
    *            element: element to be inserted into the FBF
@@ -162,8 +647,164 @@ public:
    * RETURNS: void
    ************************************************************/
   void insert(unsigned long long int element) { 
-    dyn_fbf[dpresent].insert(element);
-    dyn_fbf[dfuture].insert(element);
+    typename constituent_bf::key_digest digest;
+    generation(dpresent).compute_digest(element, digest);
+    generation(dpresent).insert(digest);
+    generation(dfuture).insert(digest);
+    if ( summaryEnabled ) {
+      typename constituent_bf::key_digest summaryDigest;
+      summary[summaryCurrent].rebase_digest(digest, summaryDigest);
+      summary[summaryCurrent].insert(summaryDigest);
+
+      // Zero the next lines of the spare, the rest is zeroed when
+      // the window opens
+      summarySpare.clear_step(summaryClearCursor, SUMMARY_CLEAR_LINES * (cache_line_size / sizeof(unsigned long long int)));
+    }
+
+    // Zero the next few cache lines of the next future BF
+    if ( 0 != cellsPerInsert ) {
+      size_t cursor = clearCursor;
+      clearingBF.clear_step(clearCursor, cellsPerInsert);
+      insertClearedCells += clearCursor - cursor;
+    }
+  }
+
+  /************************************************************
+   * FUNCTION NAME: contains
+   * 
+   * This function checks the membership of an element using 
+   * SMART RULES ie the element is present if two adjacent 
+   * constituent BFs hold it or if only the oldest BF does
+   * NOTE: The generations are probed from the future BF onwards
+   *       and the first matching pair ends the lookup, so recent
+   *       elements are the cheapest to find. With the summary BFs
+   *       enabled most absent elements need a single lookup
+   *
+   * PARAMETERS: 
+   *            element: element to be looked up in the FBF
+   * 
+   * RETURNS: (int) NOT_IN_FBF if the element is absent, else the
+   *          age bucket g of the element ie the younger BF of the
+   *          matching pair (g, g+1), or pastEnd if only the oldest
+   *          BF holds it. An element in bucket g was inserted 
+   *          roughly g to g+1 refresh periods ago
+   ************************************************************/
+  int contains(unsigned long long int element) { 
+    typename constituent_bf::key_digest digest;
+    if ( !summaryContains(element, digest) ) {
+      return NOT_IN_FBF;
+    }
+
+    bool previous = generation(dfuture).contains(digest);
+    bool current = false;
+    for ( unsigned int g = dpresent; g <= pastEnd; g++ ) {
+      current = generation(g).contains(digest);
+      if ( previous && current ) {
+        return g - 1;
+      }
+      previous = current;
+    }
+
+    return ( current ) ? (int) pastEnd : NOT_IN_FBF;
+  }
+
+  /************************************************************
+   * FUNCTION NAME: contains
+   * 
+   * This function checks the membership of a batch of elements 
+   * using SMART RULES, same result as contains(element) for 
+   * each of them
+   * NOTE: Each constituent BF is probed for the whole batch with
+   *       contains_batch(), which is vectorized when built with
+   *       -mavx2, and the rules are applied to the resulting 
+   *       bitmaps 64 elements at a time. The walk over the 
+   *       generations stops once every element has matched. With
+   *       the summary BFs enabled only the elements they hold are
+   *       looked up in the constituent BFs
+   *
+   * PARAMETERS: 
+   *            elements: elements to be looked up in the FBF
+   *            count: number of elements
+   *            ages: age bucket or NOT_IN_FBF of each element
+   * 
+   * RETURNS: void
+   ************************************************************/
+  void contains(const unsigned long long int *elements, size_t count, int *ages) { 
+    if ( !summaryEnabled || epoch < summaryUsableFrom ) {
+      walkGenerations(elements, count, ages);
+      return;
+    }
+
+    // Only the elements in the summary BFs walk the generations
+    vector<unsigned long long int> inSummary((count + 63) / 64);
+    vector<unsigned long long int> inOtherSummary((count + 63) / 64);
+    vector<unsigned long long int> candidates;
+    vector<int> candidateAges;
+    summary[0].contains_batch(elements, count, &inSummary[0]);
+    summary[1].contains_batch(elements, count, &inOtherSummary[0]);
+    for ( size_t w = 0; w < inSummary.size(); w++ ) {
+      inSummary[w] |= inOtherSummary[w];
+    }
+    fill_n(ages, count, NOT_IN_FBF);
+    for ( size_t i = 0; i < count; i++ ) {
+      if ( inSummary[i / 64] & (1ULL << (i % 64)) ) {
+        candidates.push_back(elements[i]);
+      }
+    }
+    if ( candidates.empty() ) {
+      return;
+    }
+
+    candidateAges.resize(candidates.size());
+    walkGenerations(&candidates[0], candidates.size(), &candidateAges[0]);
+    for ( size_t i = 0, c = 0; i < count; i++ ) {
+      if ( inSummary[i / 64] & (1ULL << (i % 64)) ) {
+        ages[i] = candidateAges[c++];
+      }
+    }
+  }
+
+  /************************************************************
+   * FUNCTION NAME: walkGenerations
+   * 
+   * This function applies the SMART RULES to a batch of elements
+   * by probing each constituent BF for the whole batch
+   *
+   * PARAMETERS: 
+   *            elements: elements to be looked up in the FBF
+   *            count: number of elements
+   *            ages: age bucket or NOT_IN_FBF of each element
+   * 
+   * RETURNS: void
+   ************************************************************/
+  void walkGenerations(const unsigned long long int *elements, size_t count, int *ages) { 
+    const size_t words = (count + 63) / 64;
+    vector<unsigned long long int> previous(words);
+    vector<unsigned long long int> current(words);
+    vector<unsigned long long int> pending(words, ~0ULL);
+    size_t remaining = count;
+
+    fill_n(ages, count, NOT_IN_FBF);
+    generation(dfuture).contains_batch(elements, count, &previous[0]);
+    for ( unsigned int g = dpresent; g <= pastEnd && 0 != remaining; g++ ) {
+      generation(g).contains_batch(elements, count, &current[0]);
+      for ( size_t w = 0; w < words; w++ ) {
+        unsigned long long int matched = previous[w] & current[w] & pending[w];
+        pending[w] &= ~matched;
+        for ( ; 0 != matched; matched &= matched - 1, remaining-- ) {
+          ages[w * 64 + __builtin_ctzll(matched)] = g - 1;
+        }
+      }
+      previous.swap(current);
+    }
+
+    // Only the oldest BF holds the element
+    for ( size_t w = 0; w < words && 0 != remaining; w++ ) {
+      unsigned long long int matched = previous[w] & pending[w];
+      for ( ; 0 != matched; matched &= matched - 1 ) {
+        ages[w * 64 + __builtin_ctzll(matched)] = pastEnd;
+      }
+    }
   }
 
   /************************************************************
@@ -183,36 +824,13 @@ public:
     double smartFPR = 0.0;
     unsigned int counter = 0;
     long long int i = -1;
-    unsigned int j = 0;
-    int found = 0;
 
     while ( counter != numberOfInvalids ) { 
-
-      if ( (dyn_fbf[dfuture].contains(i) && dyn_fbf[dpresent].contains(i)) ) {
-        smartFP++;
-      }
-      else if ( (dyn_fbf[dpresent].contains(i) && dyn_fbf[pastStart].contains(i)) ) {
-        smartFP++;
-      }
-      else if ( pastEnd > pastStart ) {
-        for ( j = pastStart; j <= (pastEnd - 1); j++ ) {
-          if ( (dyn_fbf[j].contains(i) && dyn_fbf[j+1].contains(i)) ) {
-            smartFP++;
-            found = 1;
-          }
-          if ( 1 == found ) {
-            goto next;
-          }
-        }
-      }
-      else if ( dyn_fbf[pastEnd].contains(i) ) {
+      if ( NOT_IN_FBF != contains(i) ) {
         smartFP++;
       }
-
-      next:
-        i--;
-        counter++;
-
+      i--;
+      counter++;
     }
 
     smartFPR = (double) smartFP/numberOfInvalids;
@@ -238,10 +856,12 @@ public:
 	double dumbFPR = 0.0;
 	unsigned int counter = 0;
 	long long int i = -1;
+	typename constituent_bf::key_digest digest;
 
 	while ( counter != numberOfInvalids ) {
+      generation(dpresent).compute_digest(i, digest);
       for ( unsigned int j = dfuture; j <= pastEnd; j++ ) {
-        if ( dyn_fbf[j].contains(i) ) {
+        if ( generation(j).contains(digest) ) {
           dumbFP++;
           break;
         }
@@ -275,18 +895,18 @@ public:
     double effectiveFPR = 0.0;
 
     //cout<<endl<<" INFO :: Individual FPP here: " <<endl;
-    //cout<<" INFO :: Future BF FPP: " <<dyn_fbf[dfuture].effective_fpp() <<endl;
+    //cout<<" INFO :: Future BF FPP: " <<generation(dfuture).effective_fpp() <<endl;
     for ( unsigned int i = dpresent; i <= pastEnd; i++ ) {
       //cout<<" INFO :: " <<i <<"BF FPP: " <<dyn_fbf[i].effective_modified_fpp() <<endl;
     }
 
-    effectiveFPR = dyn_fbf[dfuture].effective_fpp() * dyn_fbf[dpresent].effective_modified_fpp();
+    effectiveFPR = generation(dfuture).effective_fpp() * generation(dpresent).effective_modified_fpp();
     for ( counter = dpresent; counter <= (pastEnd - 1); counter++ ) {
       temp = counter + 1;
-      effectiveFPR += dyn_fbf[counter].effective_modified_fpp() * dyn_fbf[temp].effective_modified_fpp();
+      effectiveFPR += generation(counter).effective_modified_fpp() * generation(temp).effective_modified_fpp();
     }
 
-    effectiveFPR += dyn_fbf[pastEnd].effective_modified_fpp();
+    effectiveFPR += generation(pastEnd).effective_modified_fpp();
 
     //cout<<" RESULT :: The effective FPR of the FBF is: " <<effectiveFPR <<endl;
 
@@ -308,12 +928,30 @@ public:
   void triggerDynamicResizing() {
 	unsigned int newNumberOfBFs = numberOfBFs * MUL_INC_BFS;
 	cout<<endl<<endl<<endl<<"Trigerring dynamic resizing"<<endl<<endl;
+	unrollRing();
+	dyn_fbf.resize(newNumberOfBFs);
 	for ( unsigned int counter = pastEnd; counter < newNumberOfBFs; counter++ ) {
+      if ( counter > pastEnd && !generationPool.empty() ) {
+        // Reuse a trimmed BF, it was cleared when it was pooled
+        dyn_fbf[counter].swap(generationPool.back());
+        generationPool.pop_back();
+        continue;
+      }
 	  dyn_fbf[counter] = newBF;
       dyn_fbf[counter].clear();
 	}
+    // Elements inserted before the summaries were enabled now
+    // live longer
+    if ( summaryEnabled && epoch < summaryUsableFrom ) {
+      summaryUsableFrom += newNumberOfBFs - numberOfBFs;
+    }
     numberOfBFs *= MUL_INC_BFS;
     pastEnd = numberOfBFs - 1;
+    // The summaries are kept, the windows opened from now on last
+    // the new numberOfBFs refreshes and are sized for it
+    if ( summaryEnabled ) {
+      newSummarySpare();
+    }
     // For the prototype refreshRate will be decreased in the
     // application side
     refresh();
@@ -337,8 +975,23 @@ public:
 	}
 	else if ( (numberOfBFs - ADD_DEC_BFS) >= 3 ) {
 	  cout<<endl<<endl<<endl<<"Trigerring trim down"<<endl<<endl<<endl;
+      unrollRing();
       numberOfBFs -= ADD_DEC_BFS;
       pastEnd = numberOfBFs - 1;
+      // Pool the dropped BFs up to the high-water mark and
+      // release the tables of the rest
+      while ( dyn_fbf.size() > numberOfBFs ) {
+        if ( generationPool.size() < poolHighWater ) {
+          dyn_fbf.back().clear();
+          generationPool.push_back(constituent_bf());
+          generationPool.back().swap(dyn_fbf.back());
+        }
+        dyn_fbf.pop_back();
+      }
+      // The summaries are kept, elements only expire sooner
+      if ( summaryEnabled ) {
+        newSummarySpare();
+      }
       // For the prototype refreshRate will be increased in the
       // application side
       return TRUE;
@@ -361,8 +1014,99 @@ public:
     return numberOfBFs;
   }
 
+  /*************************************************************
+   * FUNCTION NAME: memoryUsage
+   *
+   * This function returns the bytes of bit table held by the
+   * FBF, ie the arena slabs, the summary BFs and their spare
+   *
+   * PARAMETERS:
+   *            NONE
+   *
+   * RETURN: number of bytes
+   *************************************************************/
+  unsigned long long int memoryUsage() {
+    unsigned long long int bytes = (unsigned long long int) arena.slot_count() * arena.slot_stride();
+    for ( unsigned int counter = 0; counter < 2; counter++ ) {
+      bytes += summary[counter].size() / bits_per_char;
+    }
+    bytes += summarySpare.size() / bits_per_char;
+    return bytes;
+  }
+
+  /*************************************************************
+   * FUNCTION NAME: printArenaStats
+   *
+   * This function prints the allocations made by the arena and
+   * how much of its slabs is not holding a live table
+   *
+   * PARAMETERS:
+   *            NONE
+   *
+   * RETURN: void
+   *************************************************************/
+  void printArenaStats() {
+    cout<<" RESULTS :: ARENA ALLOCATIONS: " <<arena.allocation_count() <<endl;
+    cout<<" RESULTS :: ARENA SLOTS: " <<arena.slot_count()
+        <<"; in use: " <<arena.slots_in_use()
+        <<"; free: " <<arena.free_slot_count() <<endl;
+    cout<<" RESULTS :: ARENA FRAGMENTATION: " <<arena.fragmentation() <<endl;
+  }
+
+  /*************************************************************
+   * FUNCTION NAME: setPoolHighWater
+   *
+   * This function sets the number of trimmed constituent BFs
+   * kept for reuse, the pooled BFs above it are freed
+   *
+   * PARAMETERS:
+   *            highWater: maximum number of pooled BFs, 0 frees
+   *                       every trimmed BF
+   *
+   * RETURN: void
+   *************************************************************/
+  void setPoolHighWater(unsigned int highWater) {
+    poolHighWater = highWater;
+    while ( generationPool.size() > poolHighWater ) {
+      generationPool.pop_back();
+    }
+  }
+
+  /*************************************************************
+   * FUNCTION NAME: retPoolSize
+   *
+   * This function returns the number of trimmed constituent BFs
+   * held for reuse
+   *
+   * PARAMETERS:
+   *            NONE
+   *
+   * RETURN: number of pooled BFs
+   *************************************************************/
+  unsigned int retPoolSize() {
+    return generationPool.size();
+  }
+
+
+}; // End of basicDynFBF class
+
+/*
+ * FBF with the classic constituent BF layout
+ */
+typedef basicDynFBF<bloom_filter> dynFBF;
+
+/*
+ * FBF with cache line blocked constituent BFs
+ */
+typedef basicDynFBF<blocked_bloom_filter> blockedDynFBF;
+
+/*
+ * FBF with epoch tagged blocked constituent BFs, clearing a 
+ * constituent BF and hence refresh take constant time
+ */
+typedef basicDynFBF<epoch_bloom_filter> epochDynFBF;
 
-}; // End of dynFBF class
+#endif
 
 /* 
  * EOF
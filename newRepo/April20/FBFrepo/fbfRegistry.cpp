@@ -0,0 +1,291 @@
+#ifndef FBF_REGISTRY_CPP
+#define FBF_REGISTRY_CPP
+
+/*
+ * Header files
+ */
+#include <iostream>
+#include <deque>
+#include <vector>
+
+/*
+ * Dynamic FBF class
+ */
+#include "dynFBF.cpp"
+
+/*
+ * Timer wheel class
+ */
+#include "timerWheel.cpp"
+
+/*
+ * Macros
+ */
+#define STAGGER_RATIO 0.6180339887498949
+
+using namespace std;
+
+/*
+ * FBF registry class
+ */
+/*******************************************************************
+ *******************************************************************
+ ** CLASS NAME: basicFBFRegistry
+ **
+ ** NOTE: This class manages many independent FBFs in one process,
+ **       eg one per tenant or stream. Every FBF has its own refresh
+ **       period and deadline, one caller refreshes all the FBFs
+ **       that are due with refreshExpired() and memoryUsage() adds
+ **       up the bit tables of all of them
+ **
+ ** The FBFs live in a deque so that adding one never moves the
+ ** others, the id of an FBF is its position in the deque. Times are
+ ** in the caller's unit, eg the seconds of a Timer
+ **
+ ** The deadlines are kept in a timer wheel with the FBF ids as
+ ** timer ids, so refreshExpired() costs the ticks elapsed and the
+ ** FBFs refreshed, not a scan of every FBF. With a stagger window
+ ** set, the first deadline of an FBF is pushed back by a fraction
+ ** of the window that depends on its id, so FBFs created or resized
+ ** together with the same period do not all clear a table in the
+ ** same tick
+ *******************************************************************
+ *******************************************************************/
+template <typename fbf_type>
+class basicFBFRegistry {
+
+public:
+  /*
+   * The FBFs, their refresh periods and next refresh deadlines
+   */
+  deque<fbf_type> fbfs;
+  vector<double> refreshPeriod;
+  vector<double> nextRefresh;
+
+  /*
+   * Deadlines of the FBFs and the ids expired by the last
+   * refreshExpired()
+   */
+  timerWheel wheel;
+  vector<unsigned int> expired;
+
+  /*
+   * Largest delay added to a first deadline, 0 for none
+   */
+  double staggerWindow;
+
+  /*
+   * Number of refreshes done so far over all the FBFs and the
+   * most done by one refreshExpired()
+   */
+  unsigned long long int refreshCount;
+  unsigned int maxRefreshBurst;
+
+  /************************************************************
+   * FUNCTION NAME: basicFBFRegistry
+   *
+   * Constructor of the FBF registry class
+   *
+   * PARAMETERS:
+   *            tick: resolution of the refresh deadlines, a
+   *                  refresh can come up to a tick early
+   *            now: current time
+   *
+   * RETURNS: NA
+   ************************************************************/
+  basicFBFRegistry(double tick = DEF_WHEEL_TICK, double now = 0)
+  : wheel(tick, now) {
+    staggerWindow = 0;
+    refreshCount = 0;
+    maxRefreshBurst = 0;
+  }
+
+  /************************************************************
+   * FUNCTION NAME: setStagger
+   *
+   * This function sets the stagger window used by the FBFs
+   * added or resized from now on
+   *
+   * PARAMETERS:
+   *            window: largest delay added to a first deadline,
+   *                    never more than the period of the FBF
+   *
+   * RETURNS: void
+   ************************************************************/
+  void setStagger(double window) {
+    staggerWindow = ( window > 0 ) ? window : 0;
+  }
+
+  /************************************************************
+   * FUNCTION NAME: staggerOffset
+   *
+   * This function returns the delay of the first deadline of
+   * an FBF. The ids are spread over the window by the golden
+   * ratio, so any run of consecutive ids is evenly spaced
+   *
+   * PARAMETERS:
+   *            id: id of the FBF
+   *            period: refresh period of the FBF
+   *
+   * RETURNS: the delay
+   ************************************************************/
+  double staggerOffset(unsigned int id, double period) {
+    double window = ( staggerWindow < period ) ? staggerWindow : period;
+    double phase = id * STAGGER_RATIO;
+    return (phase - (unsigned long long int) phase) * window;
+  }
+
+  /************************************************************
+   * FUNCTION NAME: scheduleRefresh
+   *
+   * This function puts the next deadline of an FBF in the
+   * timer wheel, FBFs that are never refreshed are left out
+   *
+   * PARAMETERS:
+   *            id: id of the FBF
+   *
+   * RETURNS: void
+   ************************************************************/
+  void scheduleRefresh(unsigned int id) {
+    if ( refreshPeriod[id] > 0 ) {
+      wheel.schedule(id, nextRefresh[id]);
+    }
+    else {
+      wheel.cancel(id);
+    }
+  }
+
+  /************************************************************
+   * FUNCTION NAME: addFBF
+   *
+   * This function creates a new FBF in the registry
+   *
+   * PARAMETERS:
+   *            numberBFs: number of constituent BFs of the FBF
+   *            tableSize: number of bits in each constituent BF
+   *            numOfHashes: number of hashes of the constituent
+   *                         BFs
+   *            period: time between two refreshes of the FBF, 0
+   *                    if it is never refreshed by the registry
+   *            now: current time
+   *
+   * RETURNS: id of the new FBF
+   ************************************************************/
+  unsigned int addFBF(unsigned long numberBFs,
+                      unsigned long long int tableSize,
+                      unsigned int numOfHashes,
+                      double period,
+                      double now) {
+    unsigned int id = fbfs.size();
+    fbfs.emplace_back(numberBFs, tableSize, numOfHashes);
+    refreshPeriod.push_back(period);
+    nextRefresh.push_back(now + period + staggerOffset(id, period));
+    scheduleRefresh(id);
+    return id;
+  }
+
+  /************************************************************
+   * FUNCTION NAME: getFBF
+   *
+   * This function returns an FBF of the registry
+   *
+   * PARAMETERS:
+   *            id: id returned by addFBF
+   *
+   * RETURNS: the FBF
+   ************************************************************/
+  fbf_type &getFBF(unsigned int id) {
+    return fbfs[id];
+  }
+
+  /************************************************************
+   * FUNCTION NAME: setRefreshPeriod
+   *
+   * This function changes the refresh period of an FBF, eg
+   * after it has been resized. The next refresh is one new
+   * period from now, plus its stagger
+   *
+   * PARAMETERS:
+   *            id: id returned by addFBF
+   *            period: new time between two refreshes
+   *            now: current time
+   *
+   * RETURNS: void
+   ************************************************************/
+  void setRefreshPeriod(unsigned int id, double period, double now) {
+    refreshPeriod[id] = period;
+    nextRefresh[id] = now + period + staggerOffset(id, period);
+    scheduleRefresh(id);
+  }
+
+  /************************************************************
+   * FUNCTION NAME: refreshExpired
+   *
+   * This function refreshes every FBF whose deadline has
+   * passed, as given by the timer wheel. An FBF is refreshed at
+   * most once per call and its deadline stays on its period
+   * grid, deadlines missed by a late call are skipped rather
+   * than caught up
+   *
+   * PARAMETERS:
+   *            now: current time
+   *
+   * RETURNS: number of FBFs refreshed
+   ************************************************************/
+  unsigned int refreshExpired(double now) {
+    expired.clear();
+    wheel.advance(now, expired);
+    for ( unsigned int counter = 0; counter < expired.size(); counter++ ) {
+      unsigned int id = expired[counter];
+      fbfs[id].refresh();
+      do {
+        nextRefresh[id] += refreshPeriod[id];
+      } while ( nextRefresh[id] <= now );
+      scheduleRefresh(id);
+    }
+    refreshCount += expired.size();
+    if ( expired.size() > maxRefreshBurst ) {
+      maxRefreshBurst = expired.size();
+    }
+    return expired.size();
+  }
+
+  /************************************************************
+   * FUNCTION NAME: memoryUsage
+   *
+   * This function returns the bytes of bit table held by all
+   * the FBFs of the registry
+   *
+   * RETURNS: number of bytes
+   ************************************************************/
+  unsigned long long int memoryUsage() {
+    unsigned long long int bytes = 0;
+    for ( unsigned int id = 0; id < fbfs.size(); id++ ) {
+      bytes += fbfs[id].memoryUsage();
+    }
+    return bytes;
+  }
+
+  /************************************************************
+   * FUNCTION NAME: retNumOfFBFs
+   *
+   * This function returns the number of FBFs in the registry
+   *
+   * RETURNS: number of FBFs
+   ************************************************************/
+  unsigned int retNumOfFBFs() {
+    return fbfs.size();
+  }
+
+}; // End of basicFBFRegistry class
+
+/*
+ * Registry of FBFs with classic constituent BFs
+ */
+typedef basicFBFRegistry<dynFBF> fbfRegistry;
+
+#endif
+
+/*
+ * EOF
+ */
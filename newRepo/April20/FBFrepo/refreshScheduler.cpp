@@ -0,0 +1,282 @@
+#ifndef REFRESH_SCHEDULER_CPP
+#define REFRESH_SCHEDULER_CPP
+
+/*
+ * Header files
+ */
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+/*
+ * Dynamic FBF class
+ */
+#include "dynFBF.cpp"
+
+/*
+ * Macros
+ */
+#define MIN_REFRESH_RATE 0.000001
+
+using namespace std;
+
+/*
+ * Refresh scheduler class
+ */
+/*******************************************************************
+ *******************************************************************
+ ** CLASS NAME: basicRefreshScheduler
+ **
+ ** NOTE: This class owns a timer thread that refreshes one FBF
+ **       every period seconds, so that the threads using the FBF
+ **       never have to look at a clock. The thread sleeps on a
+ **       condition variable until the next deadline of the steady
+ **       clock, deadlines stay on the period grid so refreshes do
+ **       not drift, and a deadline missed by more than a period is
+ **       skipped rather than caught up
+ **
+ ** The FBF is refreshed in place, it is held by reference. An FBF
+ ** that is not thread safe, eg a dynFBF, is refreshed under the
+ ** mutex given to the constructor, which its users have to take as
+ ** well. stop() wakes the thread up and joins it, the destructor
+ ** stops the scheduler so the thread never outlives the FBF
+ *******************************************************************
+ *******************************************************************/
+template <typename fbf_type>
+class basicRefreshScheduler {
+
+public:
+  /*
+   * FBF refreshed and the mutex guarding it, NULL if it can be
+   * refreshed concurrently with its other operations
+   */
+  fbf_type &fbf;
+  std::mutex *fbfMtx;
+
+  /*
+   * Timer thread and its state, guarded by schedulerMtx
+   */
+  std::thread timerThread;
+  std::mutex schedulerMtx;
+  std::condition_variable wakeUp;
+  std::chrono::steady_clock::duration period;
+  bool stopping;
+
+  /*
+   * Number of refreshes so far and the largest delay between a
+   * deadline and its refresh, in seconds
+   */
+  unsigned long long int refreshCount;
+  double maxLateness;
+
+  /************************************************************
+   * FUNCTION NAME: basicRefreshScheduler
+   *
+   * Constructor of the refresh scheduler class, the timer
+   * thread starts with start()
+   *
+   * PARAMETERS:
+   *            target: FBF to be refreshed
+   *            refreshRate: time in seconds between two refreshes,
+   *                         at least MIN_REFRESH_RATE
+   *            targetMtx: mutex guarding the FBF, NULL if none
+   *
+   * RETURNS: NA
+   ************************************************************/
+  basicRefreshScheduler(fbf_type &target,
+                        double refreshRate,
+                        std::mutex *targetMtx = NULL)
+  : fbf(target),
+    fbfMtx(targetMtx) {
+    period = toPeriod(refreshRate);
+    stopping = false;
+    refreshCount = 0;
+    maxLateness = 0.0;
+  }
+
+  /************************************************************
+   * FUNCTION NAME: ~basicRefreshScheduler
+   *
+   * Destructor of the refresh scheduler class
+   *
+   * RETURNS: NA
+   ************************************************************/
+  ~basicRefreshScheduler() {
+    stop();
+  }
+
+  /************************************************************
+   * FUNCTION NAME: toDuration
+   *
+   * This function converts seconds to a steady clock duration
+   *
+   * PARAMETERS:
+   *            seconds: time in seconds
+   *
+   * RETURNS: the duration
+   ************************************************************/
+  static std::chrono::steady_clock::duration toDuration(double seconds) {
+    return std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+  }
+
+  /************************************************************
+   * FUNCTION NAME: toPeriod
+   *
+   * This function converts a refresh rate to a period. A rate
+   * below MIN_REFRESH_RATE, eg 0, would make the timer thread
+   * spin, it is raised to MIN_REFRESH_RATE
+   *
+   * PARAMETERS:
+   *            refreshRate: time in seconds between two refreshes
+   *
+   * RETURNS: the period
+   ************************************************************/
+  static std::chrono::steady_clock::duration toPeriod(double refreshRate) {
+    if ( !(refreshRate >= MIN_REFRESH_RATE) ) {
+      cout<<" ERROR :: Refresh rate " <<refreshRate <<" raised to " <<MIN_REFRESH_RATE <<endl;
+      refreshRate = MIN_REFRESH_RATE;
+    }
+    return toDuration(refreshRate);
+  }
+
+  /************************************************************
+   * FUNCTION NAME: start
+   *
+   * This function starts the timer thread, the first refresh
+   * is one period from now
+   *
+   * RETURNS: void
+   ************************************************************/
+  void start() {
+    if ( timerThread.joinable() ) {
+      return;
+    }
+    stopping = false;
+    timerThread = std::thread(&basicRefreshScheduler::timerLoop, this);
+  }
+
+  /************************************************************
+   * FUNCTION NAME: stop
+   *
+   * This function stops the timer thread and waits for it, a
+   * refresh in progress completes first
+   *
+   * RETURNS: void
+   ************************************************************/
+  void stop() {
+    {
+      std::lock_guard<std::mutex> guard(schedulerMtx);
+      stopping = true;
+    }
+    wakeUp.notify_all();
+    if ( timerThread.joinable() ) {
+      timerThread.join();
+    }
+  }
+
+  /************************************************************
+   * FUNCTION NAME: setRefreshRate
+   *
+   * This function changes the refresh period, eg after a
+   * dynamic resizing. The next refresh is one new period after
+   * the last one
+   *
+   * PARAMETERS:
+   *            refreshRate: time in seconds between two refreshes,
+   *                         at least MIN_REFRESH_RATE
+   *
+   * RETURNS: void
+   ************************************************************/
+  void setRefreshRate(double refreshRate) {
+    {
+      std::lock_guard<std::mutex> guard(schedulerMtx);
+      period = toPeriod(refreshRate);
+    }
+    wakeUp.notify_all();
+  }
+
+  /************************************************************
+   * FUNCTION NAME: timerLoop
+   *
+   * This function is run by the timer thread, it sleeps until
+   * the next deadline and refreshes the FBF. A wake up for a
+   * stop or a new period computes the deadline again
+   *
+   * RETURNS: void
+   ************************************************************/
+  void timerLoop() {
+    std::unique_lock<std::mutex> lock(schedulerMtx);
+    std::chrono::steady_clock::time_point last = std::chrono::steady_clock::now();
+
+    while ( !stopping ) {
+      std::chrono::steady_clock::time_point deadline = last + period;
+      std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+      if ( now < deadline ) {
+        wakeUp.wait_until(lock, deadline);
+        continue;
+      }
+
+      double lateness = std::chrono::duration<double>(now - deadline).count();
+      if ( lateness > maxLateness ) {
+        maxLateness = lateness;
+      }
+
+      // The FBF lock is never taken under schedulerMtx
+      lock.unlock();
+      if ( NULL != fbfMtx ) {
+        std::lock_guard<std::mutex> guard(*fbfMtx);
+        fbf.refresh();
+      }
+      else {
+        fbf.refresh();
+      }
+      lock.lock();
+
+      refreshCount++;
+      last = deadline;
+      now = std::chrono::steady_clock::now();
+      while ( period.count() > 0 && last + period <= now ) {
+        last += period;
+      }
+    }
+  }
+
+  /*************************************************************
+   * FUNCTION NAME: retRefreshCount
+   *
+   * This function returns the number of refreshes so far
+   *
+   * RETURN: number of refreshes
+   *************************************************************/
+  unsigned long long int retRefreshCount() {
+    std::lock_guard<std::mutex> guard(schedulerMtx);
+    return refreshCount;
+  }
+
+  /*************************************************************
+   * FUNCTION NAME: retMaxLateness
+   *
+   * This function returns the largest delay between a deadline
+   * and its refresh
+   *
+   * RETURN: delay in seconds
+   *************************************************************/
+  double retMaxLateness() {
+    std::lock_guard<std::mutex> guard(schedulerMtx);
+    return maxLateness;
+  }
+
+}; // End of basicRefreshScheduler class
+
+/*
+ * Refresh scheduler of an FBF with classic constituent BFs
+ */
+typedef basicRefreshScheduler<dynFBF> refreshScheduler;
+
+#endif
+
+/*
+ * EOF
+ */
@@ -0,0 +1,326 @@
+#ifndef SHARDED_FBF_CPP
+#define SHARDED_FBF_CPP
+
+/*
+ * Header files
+ */
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <atomic>
+#include <mutex>
+
+/*
+ * Dynamic FBF class
+ */
+#include "dynFBF.cpp"
+
+using namespace std;
+
+/*
+ * Sharded FBF class
+ */
+/*******************************************************************
+ *******************************************************************
+ ** CLASS NAME: basicShardedFBF (Hash sharded Forgetful Bloom Filter)
+ **
+ ** NOTE: This class splits an FBF into shards, each a complete FBF
+ **       with its own tables and lock. A key is routed to one shard
+ **       by a hash independent of the constituent BF hashes, so
+ **       threads working on different shards never touch the same
+ **       cache lines. Each shard is sized for its share of the keys
+ **
+ ** A refresh only bumps the global refresh count. A shard catches
+ ** up with it, under its lock, before its next insert or query, so
+ ** every shard rotates at the same logical instant without the
+ ** refresh having to stop the inserting threads
+ **
+ ** The batched insert and contains sort the keys by shard first and
+ ** then take each shard lock once per batch
+ *******************************************************************
+ *******************************************************************/
+template <typename fbf_type>
+class basicShardedFBF {
+
+public:
+  /*
+   * One shard, its lock and the number of refreshes it has done.
+   * Aligned so that the locks of two shards never share a line
+   */
+  struct alignas(64) fbfShard {
+    fbf_type fbf;
+    std::mutex mtx;
+    unsigned long long int refreshes;
+
+    fbfShard(unsigned long numberBFs,
+             unsigned long long int tableSize,
+             unsigned int numOfHashes)
+    : fbf(numberBFs, tableSize, numOfHashes),
+      refreshes(0) {}
+  };
+
+  /*
+   * The shards, in a deque as an FBF can be neither copied nor
+   * moved
+   */
+  deque<fbfShard> shards;
+
+  /*
+   * Number of refreshes of the sharded FBF
+   */
+  std::atomic<unsigned long long int> globalRefreshes;
+
+  /************************************************************
+   * FUNCTION NAME: basicShardedFBF
+   *
+   * Constructor of the sharded FBF class
+   *
+   * PARAMETERS:
+   *            numberOfShards: number of shards, eg one per core
+   *            numberBFs: number of constituent BFs of each shard
+   *            tableSize: number of bits in each constituent BF
+   *                       of a shard
+   *            numOfHashes: number of hashes of the constituent
+   *                         BFs
+   *
+   * RETURNS: NA
+   ************************************************************/
+  basicShardedFBF(unsigned int numberOfShards,
+                  unsigned long numberBFs,
+                  unsigned long long int tableSize,
+                  unsigned int numOfHashes) {
+    if ( 0 == numberOfShards ) {
+      numberOfShards = 1;
+    }
+    for ( unsigned int shard = 0; shard < numberOfShards; shard++ ) {
+      shards.emplace_back(numberBFs, tableSize, numOfHashes);
+    }
+    globalRefreshes.store(0);
+    cout<<" INFO :: NUMBER OF SHARDS: " <<numberOfShards <<endl;
+  }
+
+  /************************************************************
+   * FUNCTION NAME: shardOf
+   *
+   * This function routes a key to its shard. The key is mixed
+   * with the 64 bit finalizer of MurmurHash3 and the high half
+   * is mapped onto the shards with a multiply and a shift
+   *
+   * PARAMETERS:
+   *            element: key to be routed
+   *
+   * RETURNS: the shard of the key
+   ************************************************************/
+  unsigned int shardOf(unsigned long long int element) {
+    unsigned long long int h = element;
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+    return (unsigned int) (((h >> 32) * shards.size()) >> 32);
+  }
+
+  /************************************************************
+   * FUNCTION NAME: catchUp
+   *
+   * This function refreshes a shard until it has done as many
+   * refreshes as the sharded FBF. Called under the shard lock
+   * NOTE: numberOfBFs refreshes empty every constituent BF, so an
+   *       idle shard replays at most that many
+   *
+   * PARAMETERS:
+   *            shard: shard to bring up to date
+   *
+   * RETURNS: void
+   ************************************************************/
+  void catchUp(fbfShard &shard) {
+    unsigned long long int target = globalRefreshes.load(std::memory_order_acquire);
+    unsigned long long int replays = 0;
+    while ( shard.refreshes + replays < target && replays < shard.fbf.retNumOfBFs() ) {
+      shard.fbf.refresh();
+      replays++;
+    }
+    shard.refreshes = target;
+  }
+
+  /************************************************************
+   * FUNCTION NAME: refresh
+   *
+   * This function refreshes every shard at the same logical
+   * instant, the shards do the actual refresh on their next
+   * use
+   *
+   * RETURNS: void
+   ************************************************************/
+  void refresh() {
+    globalRefreshes.fetch_add(1, std::memory_order_release);
+  }
+
+  /************************************************************
+   * FUNCTION NAME: insert
+   *
+   * This function inserts an element into its shard
+   *
+   * PARAMETERS:
+   *            element: element to be inserted into the FBF
+   *
+   * RETURNS: void
+   ************************************************************/
+  void insert(unsigned long long int element) {
+    fbfShard &shard = shards[shardOf(element)];
+    std::lock_guard<std::mutex> guard(shard.mtx);
+    catchUp(shard);
+    shard.fbf.insert(element);
+  }
+
+  /************************************************************
+   * FUNCTION NAME: insert
+   *
+   * This function inserts a batch of elements. The elements are
+   * sorted by shard with a counting sort and every shard is
+   * then locked once for all its elements
+   *
+   * PARAMETERS:
+   *            elements: elements to be inserted into the FBF
+   *            count: number of elements
+   *
+   * RETURNS: void
+   ************************************************************/
+  void insert(const unsigned long long int *elements, size_t count) {
+    vector<size_t> start;
+    vector<unsigned long long int> sorted;
+    sortByShard(elements, count, start, sorted, NULL);
+    for ( unsigned int s = 0; s < shards.size(); s++ ) {
+      if ( start[s] == start[s + 1] ) {
+        continue;
+      }
+      std::lock_guard<std::mutex> guard(shards[s].mtx);
+      catchUp(shards[s]);
+      for ( size_t i = start[s]; i < start[s + 1]; i++ ) {
+        shards[s].fbf.insert(sorted[i]);
+      }
+    }
+  }
+
+  /************************************************************
+   * FUNCTION NAME: contains
+   *
+   * This function checks the membership of an element in its
+   * shard using SMART RULES
+   *
+   * PARAMETERS:
+   *            element: element to be looked up in the FBF
+   *
+   * RETURNS: (int) NOT_IN_FBF or the age bucket of the element,
+   *          see dynFBF::contains
+   ************************************************************/
+  int contains(unsigned long long int element) {
+    fbfShard &shard = shards[shardOf(element)];
+    std::lock_guard<std::mutex> guard(shard.mtx);
+    catchUp(shard);
+    return shard.fbf.contains(element);
+  }
+
+  /************************************************************
+   * FUNCTION NAME: contains
+   *
+   * This function checks the membership of a batch of elements,
+   * each shard is locked once and looked up with the batched
+   * contains of its FBF
+   *
+   * PARAMETERS:
+   *            elements: elements to be looked up in the FBF
+   *            count: number of elements
+   *            ages: age bucket or NOT_IN_FBF of each element
+   *
+   * RETURNS: void
+   ************************************************************/
+  void contains(const unsigned long long int *elements, size_t count, int *ages) {
+    vector<size_t> start;
+    vector<unsigned long long int> sorted;
+    vector<size_t> position;
+    sortByShard(elements, count, start, sorted, &position);
+    vector<int> sortedAges(count);
+    for ( unsigned int s = 0; s < shards.size(); s++ ) {
+      if ( start[s] == start[s + 1] ) {
+        continue;
+      }
+      std::lock_guard<std::mutex> guard(shards[s].mtx);
+      catchUp(shards[s]);
+      shards[s].fbf.contains(&sorted[start[s]], start[s + 1] - start[s], &sortedAges[start[s]]);
+    }
+    for ( size_t i = 0; i < count; i++ ) {
+      ages[position[i]] = sortedAges[i];
+    }
+  }
+
+  /************************************************************
+   * FUNCTION NAME: sortByShard
+   *
+   * This function groups a batch of elements by shard with a
+   * counting sort. The elements of shard s end up in
+   * sorted[start[s]] to sorted[start[s + 1] - 1], in their
+   * original order
+   *
+   * PARAMETERS:
+   *            elements: elements to be sorted
+   *            count: number of elements
+   *            start: first position of each shard, plus the end
+   *            sorted: the grouped elements
+   *            position: if not NULL, original position of each
+   *                      grouped element
+   *
+   * RETURNS: void
+   ************************************************************/
+  void sortByShard(const unsigned long long int *elements,
+                   size_t count,
+                   vector<size_t> &start,
+                   vector<unsigned long long int> &sorted,
+                   vector<size_t> *position) {
+    vector<unsigned int> shardIds(count);
+    start.assign(shards.size() + 1, 0);
+    for ( size_t i = 0; i < count; i++ ) {
+      shardIds[i] = shardOf(elements[i]);
+      start[shardIds[i] + 1]++;
+    }
+    for ( unsigned int s = 0; s < shards.size(); s++ ) {
+      start[s + 1] += start[s];
+    }
+    vector<size_t> next(start.begin(), start.end() - 1);
+    sorted.resize(count);
+    if ( NULL != position ) {
+      position->resize(count);
+    }
+    for ( size_t i = 0; i < count; i++ ) {
+      size_t to = next[shardIds[i]]++;
+      sorted[to] = elements[i];
+      if ( NULL != position ) {
+        (*position)[to] = i;
+      }
+    }
+  }
+
+  /*************************************************************
+   * FUNCTION NAME: retNumOfShards
+   *
+   * This function returns the number of shards
+   *
+   * RETURN: number of shards
+   *************************************************************/
+  unsigned int retNumOfShards() {
+    return shards.size();
+  }
+
+}; // End of basicShardedFBF class
+
+/*
+ * Sharded FBF with classic constituent BFs
+ */
+typedef basicShardedFBF<dynFBF> shardedFBF;
+
+#endif
+
+/*
+ * EOF
+ */
@@ -0,0 +1,680 @@
+#ifndef SLICED_FBF_CPP
+#define SLICED_FBF_CPP
+
+/*
+ * Header files
+ */
+#include <iostream>
+#include <vector>
+
+/*
+ * Bloom Filter Library
+ */
+#include "bloom_filter.hpp"
+
+/*
+ * Dynamic FBF class, the macros are shared
+ */
+#include "dynFBF.cpp"
+
+/*
+ * Macros
+ */
+#define SLICED_BATCH_GROUP 16
+
+using namespace std;
+
+/*
+ * Bit sliced FBF class
+ */
+/*******************************************************************
+ *******************************************************************
+ ** CLASS NAME: basicSlicedFBF (Bit sliced Forgetful Bloom Filter)
+ **
+ ** NOTE: This class is an alternative storage engine for the
+ **       dynamic FBF. All the constituent BFs share the same hash
+ **       functions and table size, so instead of one bit table per
+ **       constituent BF there is one table of words where bit g of
+ **       the word at position p is bit p of constituent BF g
+ **
+ ** An insert sets the future and present bits of k words and a
+ ** query ANDs k words to get the set of constituent BFs holding the
+ ** key, so both cost k memory accesses whatever the number of
+ ** constituent BFs. The smart rules then become a few bitwise ops
+ **
+ ** Like dynFBF the constituent BFs form a logical ring, generation
+ ** g lives in bit (head + g) % numberOfBFs. A refresh moves head
+ ** back by one, that bit has to be cleared in every word. It is
+ ** cleared lazily: each cache line of words carries the refresh it
+ ** was last brought up to date with, a query masks out the bits
+ ** recycled since and an insert clears them from the line first,
+ ** so a refresh costs no pass over the table. The tag takes the
+ ** last 8 bytes of the line, 1/8 of the memory, so checking it
+ ** costs no extra cache miss and the words are caught up 8 bytes at
+ ** a time
+ **
+ ** The word type is a template parameter, it bounds the number of
+ ** constituent BFs and sets the memory used per bit position, see
+ ** the slicedFBF typedefs below
+ *******************************************************************
+ *******************************************************************/
+template <typename slice_type>
+class basicSlicedFBF {
+
+public:
+  /*
+   * Maximum number of constituent BFs, one per bit of a word
+   */
+  static const unsigned int maxNumberOfBFs = sizeof(slice_type) * 8;
+
+  /*
+   * Bloom Filter parameters
+   */
+  bloom_parameters parameters;
+
+  /*
+   * BF used only for its hash functions, its bit table is unused.
+   * It is what makes the slices compatible with the constituent
+   * BFs of a dynFBF built from the same parameters
+   */
+  bloom_filter hashBF;
+
+  /*
+   * One word per bit position of the constituent BFs, packed
+   * wordsPerLine to a cache line with the refresh the line was
+   * last brought up to date with
+   */
+  static const unsigned int chunksPerLine = cache_line_size / sizeof(unsigned long long int) - 1;
+  static const unsigned int wordsPerLine = chunksPerLine * sizeof(unsigned long long int) / sizeof(slice_type);
+  struct alignas(64) sliceLine {
+    union {
+      slice_type word[wordsPerLine];
+      unsigned long long int chunk[chunksPerLine];
+    };
+    unsigned long long int epoch;
+  };
+  vector<sliceLine> slices;
+
+  /*
+   * Number of refreshes so far
+   */
+  unsigned long long int refreshEpoch;
+
+  /*
+   * Physical bits recycled by the last d refreshes, for d up to
+   * numberOfBFs, see staleBits
+   */
+  unsigned long long int recycledBits[maxNumberOfBFs + 1];
+
+  /*
+   * Number of elements inserted into each constituent BF, by bit
+   */
+  unsigned long long int elementCount[maxNumberOfBFs];
+
+  /*
+   * Bit holding the future BF
+   */
+  unsigned int head;
+
+  /*
+   * Logical generations of the future, present and first past BF,
+   * the number of constituent BFs and the oldest past BF, as in 
+   * dynFBF
+   */
+  unsigned int dfuture;
+  unsigned int dpresent;
+  unsigned int pastStart;
+  unsigned int numberOfBFs;
+  unsigned int pastEnd;
+
+  /************************************************************
+   * FUNCTION NAME: basicSlicedFBF
+   *
+   * Constructor of the bit sliced FBF class
+   *
+   * PARAMETERS:
+   *            numberOfBFs: gives the number of constituent BFs
+   *                         to be initialized in the FBF
+   *            tableSize: gives the number of bits in each of the
+   *                       constituent BFs in the FBF
+   *            numOfHashes: gives the number of hashes to be used
+   *                         by the constituent BFs in the FBF
+   *
+   * RETURNS: NA
+   ************************************************************/
+  basicSlicedFBF(unsigned long numberBFs,
+                 unsigned long long int tableSize,
+                 unsigned int numOfHashes) {
+
+    parameters.projected_element_count = 10000;
+    parameters.false_positive_probability = 0.0001;
+    parameters.random_seed = 0xA5A5A5A5;
+    if ( !parameters ) {
+      cout<<" ERROR :: Invalid set of bloom filter parameters " <<endl;
+    }
+    parameters.compute_optimal_parameters(tableSize, numOfHashes);
+
+    if ( numberBFs > maxNumberOfBFs ) {
+      cout<<" ERROR :: At most " <<maxNumberOfBFs <<" constituent BFs fit in a slice " <<endl;
+      numberBFs = maxNumberOfBFs;
+    }
+
+    hashBF = bloom_filter(parameters);
+    slices.assign((hashBF.size() + wordsPerLine - 1) / wordsPerLine, sliceLine());
+    refreshEpoch = 0;
+    fill_n(elementCount, maxNumberOfBFs, 0);
+    cout<<" INFO :: NUMBER OF CONSTITUENT BFs initialized in the FBF: " <<numberBFs <<endl;
+
+    // Update the class members
+    dfuture = DFUTURE;
+    dpresent = DFUTURE + 1;
+    pastStart = DFUTURE + 2;
+    numberOfBFs = numberBFs;
+    pastEnd = numberBFs - 1;
+    head = 0;
+    updateRecycledBits();
+
+    cout<<" INFO :: dfuture: " <<dfuture <<endl;
+    cout<<" INFO :: dpresent: " <<dpresent <<endl;
+    cout<<" INFO :: pastStart: " <<pastStart <<endl;
+    cout<<" INFO :: pastEnd: " <<pastEnd <<endl;
+
+    cout<<" INFO :: Sliced FBF initialized " <<endl;
+  }
+
+  /************************************************************
+   * FUNCTION NAME: ~basicSlicedFBF
+   *
+   * Destructor of the bit sliced FBF class
+   *
+   * RETURNS: NA
+   ************************************************************/
+  ~basicSlicedFBF() {}
+
+  /************************************************************
+   * FUNCTION NAME: generationBit
+   *
+   * This function maps a logical generation to its bit in the
+   * slices
+   *
+   * PARAMETERS:
+   *            g: logical generation, 0 <= g < numberOfBFs
+   *
+   * RETURNS: (unsigned int) bit of generation g
+   ************************************************************/
+  inline unsigned int generationBit(unsigned int g) {
+    unsigned int bit = head + g;
+    if ( bit >= numberOfBFs ) {
+      bit -= numberOfBFs;
+    }
+    return bit;
+  }
+
+  /************************************************************
+   * FUNCTION NAME: generations
+   *
+   * This function returns the set of constituent BFs that hold
+   * all the k bits of the key, bit g set if generation g does
+   *
+   * PARAMETERS:
+   *            element: element to be looked up
+   *
+   * RETURNS: (unsigned long long int) generation mask
+   ************************************************************/
+  inline unsigned long long int generations(long long int element) {
+    bloom_filter::key_digest digest;
+    hashBF.compute_digest(element, digest);
+    return generations(digest);
+  }
+
+  /************************************************************
+   * FUNCTION NAME: generations
+   *
+   * This function returns the generation mask of a hashed key,
+   * ignoring the bits recycled since its words were written
+   *
+   * PARAMETERS:
+   *            digest: digest of the key
+   *
+   * RETURNS: (unsigned long long int) generation mask
+   ************************************************************/
+  inline unsigned long long int generations(const bloom_filter::key_digest &digest) {
+    const size_t *bitIndex = digest.bit_index();
+    unsigned long long int mask = ~0ULL;
+    for ( size_t i = 0; i < digest.hash_count() && 0 != mask; i++ ) {
+      const sliceLine &line = slices[bitIndex[i] / wordsPerLine];
+      mask &= line.word[bitIndex[i] % wordsPerLine] & ~staleBits(line.epoch);
+    }
+
+    // Rotate the physical bits into generation order
+    if ( 0 != head ) {
+      mask = (mask >> head) | (mask << (numberOfBFs - head));
+    }
+    return mask & lowMask(numberOfBFs);
+  }
+
+  /************************************************************
+   * FUNCTION NAME: refresh
+   *
+   * This function refreshes the FBF
+   * NOTE: The bit of the oldest BF becomes the bit of the new
+   *       future BF, it is the only bit cleared and only when a
+   *       line is next used
+   *
+   * RETURNS: void
+   ************************************************************/
+  void refresh() {
+
+    head = ( 0 == head ) ? (numberOfBFs - 1) : (head - 1);
+    refreshEpoch++;
+    elementCount[head] = 0;
+    updateRecycledBits();
+
+    cout<<endl<<endl<<endl<<endl <<" INFO :: Refreshed FBF" <<endl<<endl<<endl<<endl;
+  }
+
+  /************************************************************
+   * FUNCTION NAME: insert
+   *
+   * This function inserts into the FBF
+   * NOTE: The present and future bits are set together so each
+   *       hash costs a single memory access
+   *
+   * PARAMETERS:
+   *            element: element to be inserted into the FBF
+   *
+   * RETURNS: void
+   ************************************************************/
+  void insert(unsigned long long int element) {
+    bloom_filter::key_digest digest;
+    hashBF.compute_digest(element, digest);
+
+    const slice_type bits = static_cast<slice_type>((1ULL << generationBit(dfuture)) | (1ULL << generationBit(dpresent)));
+    const size_t *bitIndex = digest.bit_index();
+    for ( size_t i = 0; i < digest.hash_count(); i++ ) {
+      sliceLine &line = slices[bitIndex[i] / wordsPerLine];
+      if ( line.epoch != refreshEpoch ) {
+        catchUp(line);
+      }
+      line.word[bitIndex[i] % wordsPerLine] |= bits;
+    }
+    elementCount[generationBit(dfuture)]++;
+    elementCount[generationBit(dpresent)]++;
+  }
+
+  /************************************************************
+   * FUNCTION NAME: contains
+   *
+   * This function checks the membership of an element using
+   * SMART RULES, same result as dynFBF::contains()
+   *
+   * PARAMETERS:
+   *            element: element to be looked up in the FBF
+   *
+   * RETURNS: (int) NOT_IN_FBF if the element is absent, else the
+   *          age bucket of the element
+   ************************************************************/
+  int contains(unsigned long long int element) {
+    return smartAge(generations(element));
+  }
+
+  /************************************************************
+   * FUNCTION NAME: contains
+   *
+   * This function checks the membership of a batch of elements
+   * using SMART RULES
+   * NOTE: The elements are taken SLICED_BATCH_GROUP at a time.
+   *       The whole group is hashed and its words prefetched
+   *       before any of them is read, so the k cache misses of
+   *       the elements of a group overlap instead of following
+   *       one another
+   *
+   * PARAMETERS:
+   *            elements: elements to be looked up in the FBF
+   *            count: number of elements
+   *            ages: age bucket or NOT_IN_FBF of each element
+   *
+   * RETURNS: void
+   ************************************************************/
+  void contains(const unsigned long long int *elements, size_t count, int *ages) {
+    bloom_filter::key_digest digest[SLICED_BATCH_GROUP];
+
+    for ( size_t first = 0; first < count; first += SLICED_BATCH_GROUP ) {
+      const size_t group = min<size_t>(SLICED_BATCH_GROUP, count - first);
+      for ( size_t j = 0; j < group; j++ ) {
+        hashBF.compute_digest(elements[first + j], digest[j]);
+        const size_t *bitIndex = digest[j].bit_index();
+        for ( size_t i = 0; i < digest[j].hash_count(); i++ ) {
+          __builtin_prefetch(&slices[bitIndex[i] / wordsPerLine]);
+        }
+      }
+      for ( size_t j = 0; j < group; j++ ) {
+        ages[first + j] = smartAge(generations(digest[j]));
+      }
+    }
+  }
+
+  /************************************************************
+   * FUNCTION NAME: checkSmartFBF_FPR
+   *
+   * This function checks the False Positives (FPs) and the
+   * False Positive Rate (FPR) of the FBF using SMART RULES
+   *
+   * PARAMETERS:
+   *            numberOfInvalids: Number of invalid membership
+   *                              checks to be made
+   *
+   * RETURNS: void
+   ***********************************************************/
+  void checkSmartFBF_FPR(unsigned long long int numberOfInvalids) {
+    unsigned long long int smartFP = 0;
+    double smartFPR = 0.0;
+    long long int i = -1;
+
+    for ( unsigned long long int counter = 0; counter != numberOfInvalids; counter++, i-- ) {
+      if ( NOT_IN_FBF != contains(i) ) {
+        smartFP++;
+      }
+    }
+
+    smartFPR = (double) smartFP/numberOfInvalids;
+
+    cout<<" RESULT :: SMART FP = " <<smartFP <<endl;
+    cout<<" RESULT :: SMART FPR = " <<smartFPR <<endl;
+  }
+
+  /************************************************************
+   * FUNCTION NAME: checkDumbFBF_FPR
+   *
+   * This function checks the False Positives (FPs) and the
+   * False Positive Rate (FPR) of the FBF using NAIVE RULES
+   *
+   * PARAMETERS:
+   *            numberOfInvalids: Number of invalid membership
+   *                              checks to be made
+   *
+   * RETURNS: void
+   ***********************************************************/
+  void checkDumbFBF_FPR(unsigned long long int numberOfInvalids) {
+    unsigned long long int dumbFP = 0;
+    double dumbFPR = 0.0;
+    long long int i = -1;
+
+    for ( unsigned long long int counter = 0; counter != numberOfInvalids; counter++, i-- ) {
+      if ( 0 != generations(i) ) {
+        dumbFP++;
+      }
+    }
+
+    dumbFPR = (double) dumbFP/numberOfInvalids;
+
+    cout<<" RESULT :: DUMB FP = " <<dumbFP <<endl;
+    cout<<" RESULT :: DUMB FPR = " <<dumbFPR <<endl;
+  }
+
+  /************************************************************
+   * FUNCTION NAME: checkEffectiveFPR
+   *
+   * This function checks the effective FPR of the FBF, same
+   * model as dynFBF::checkEffectiveFPR()
+   *
+   * RETURNS: (double) effective FPR
+   ***********************************************************/
+  double checkEffectiveFPR() {
+    double effectiveFPR = 0.0;
+
+    effectiveFPR = fpp(elementCount[generationBit(dfuture)]) * fpp(elementCount[generationBit(dpresent)] / 2);
+    for ( unsigned int counter = dpresent; counter <= (pastEnd - 1); counter++ ) {
+      effectiveFPR += fpp(elementCount[generationBit(counter)] / 2) * fpp(elementCount[generationBit(counter + 1)] / 2);
+    }
+
+    effectiveFPR += fpp(elementCount[generationBit(pastEnd)] / 2);
+
+    return effectiveFPR;
+  }
+
+  /************************************************************
+   * FUNCTION NAME: triggerDynamicResizing
+   *
+   * This function does a multiplicative increase of the number
+   * of constituent bloom filter and additive decrease in the
+   * refresh rate
+   *
+   * PARAMETERS:
+   *            NONE
+   *
+   * RETURNS: void
+   ************************************************************/
+  void triggerDynamicResizing() {
+    unsigned int newNumberOfBFs = numberOfBFs * MUL_INC_BFS;
+    if ( newNumberOfBFs > maxNumberOfBFs ) {
+      cout<<" ERROR :: At most " <<maxNumberOfBFs <<" constituent BFs fit in a slice " <<endl;
+      return;
+    }
+    cout<<endl<<endl<<endl<<"Trigerring dynamic resizing"<<endl<<endl;
+    // Same as dynFBF, the oldest BF and the new ones start empty
+    unrollRing(numberOfBFs, lowMask(pastEnd));
+    for ( unsigned int counter = pastEnd; counter < newNumberOfBFs; counter++ ) {
+      elementCount[counter] = 0;
+    }
+    numberOfBFs *= MUL_INC_BFS;
+    pastEnd = numberOfBFs - 1;
+    // For the prototype refreshRate will be decreased in the
+    // application side
+    refresh();
+  }
+
+  /************************************************************
+   * FUNCTION NAME: triggerTrimDown
+   *
+   * This function does a additive decrease of the number of
+   * constituent bloom filter and additive increase in the
+   * refresh rate
+   *
+   * PARAMETERS:
+   *            NONE
+   *
+   * RETURNS: void
+   *************************************************************/
+  int triggerTrimDown() {
+    if ( numberOfBFs < 4 ) {
+      return FALSE;
+    }
+    else if ( (numberOfBFs - ADD_DEC_BFS) >= 3 ) {
+      cout<<endl<<endl<<endl<<"Trigerring trim down"<<endl<<endl<<endl;
+      unrollRing(numberOfBFs, lowMask(numberOfBFs - ADD_DEC_BFS));
+      numberOfBFs -= ADD_DEC_BFS;
+      pastEnd = numberOfBFs - 1;
+      updateRecycledBits();
+      // For the prototype refreshRate will be increased in the
+      // application side
+      return TRUE;
+    }
+    return FALSE;
+  }
+
+  /*************************************************************
+   * FUNCTION NAME: retNumOfBFs
+   *
+   * This function return the number of constituent BFs in the
+   * FBF
+   *
+   * PARAMETERS:
+   *            NONE
+   *
+   * RETURN: void
+   *************************************************************/
+  unsigned int retNumOfBFs() {
+    return numberOfBFs;
+  }
+
+private:
+
+  /************************************************************
+   * FUNCTION NAME: lowMask
+   *
+   * RETURNS: (unsigned long long int) word with the n low bits set
+   ************************************************************/
+  static inline unsigned long long int lowMask(unsigned int n) {
+    return ( n >= 64 ) ? ~0ULL : ((1ULL << n) - 1);
+  }
+
+  /************************************************************
+   * FUNCTION NAME: smartAge
+   *
+   * This function applies the SMART RULES to a generation mask
+   *
+   * RETURNS: (int) NOT_IN_FBF or the age bucket of the key
+   ************************************************************/
+  inline int smartAge(unsigned long long int mask) {
+    const unsigned long long int pairs = mask & (mask >> 1);
+
+    if ( 0 != pairs ) {
+      return __builtin_ctzll(pairs);
+    }
+    return ( 0 != (mask & (1ULL << pastEnd)) ) ? (int) pastEnd : NOT_IN_FBF;
+  }
+
+  /************************************************************
+   * FUNCTION NAME: staleBits
+   *
+   * This function returns the bits of a cache line of words that
+   * were recycled by the refreshes since it was brought up to
+   * date. d refreshes recycle the d newest generations
+   *
+   * PARAMETERS:
+   *            epoch: refresh the line was brought up to date with
+   *
+   * RETURNS: (unsigned long long int) physical bits to clear
+   ************************************************************/
+  inline unsigned long long int staleBits(unsigned long long int epoch) {
+    const unsigned long long int missed = refreshEpoch - epoch;
+    return recycledBits[( missed < numberOfBFs ) ? missed : numberOfBFs];
+  }
+
+  /************************************************************
+   * FUNCTION NAME: updateRecycledBits
+   *
+   * This function computes recycledBits, to be called whenever
+   * head or numberOfBFs changes
+   *
+   * RETURNS: void
+   ************************************************************/
+  void updateRecycledBits() {
+    unsigned long long int recycled = 0;
+    for ( unsigned int missed = 0; missed <= numberOfBFs; missed++ ) {
+      // A shift by numberOfBFs - head only wraps to 0 when head is 0
+      recycledBits[missed] = ((recycled << head) | (recycled >> ((numberOfBFs - head) & 63))) & lowMask(numberOfBFs);
+      recycled = (recycled << 1) | 1;
+    }
+  }
+
+  /************************************************************
+   * FUNCTION NAME: catchUp
+   *
+   * This function clears the recycled bits from a cache line of
+   * words and tags it with the current refresh
+   *
+   * PARAMETERS:
+   *            line: cache line of the slices
+   *
+   * RETURNS: void
+   ************************************************************/
+  inline void catchUp(sliceLine &line) {
+    const unsigned long long int keep = static_cast<slice_type>(~staleBits(line.epoch)) * (~0ULL / lowMask(8 * sizeof(slice_type)));
+    for ( unsigned int i = 0; i < chunksPerLine; i++ ) {
+      line.chunk[i] &= keep;
+    }
+    line.epoch = refreshEpoch;
+  }
+
+  /************************************************************
+   * FUNCTION NAME: catchUpAll
+   *
+   * This function brings every cache line of words up to date
+   *
+   * RETURNS: void
+   ************************************************************/
+  void catchUpAll() {
+    for ( size_t line = 0; line < slices.size(); line++ ) {
+      catchUp(slices[line]);
+    }
+  }
+
+  /************************************************************
+   * FUNCTION NAME: clearBits
+   *
+   * This function ANDs every word of the slices with keep
+   *
+   * RETURNS: void
+   ************************************************************/
+  void clearBits(unsigned long long int keep) {
+    const slice_type keepBits = static_cast<slice_type>(keep);
+    for ( size_t line = 0; line < slices.size(); line++ ) {
+      slice_type *word = slices[line].word;
+      for ( unsigned int i = 0; i < wordsPerLine; i++ ) {
+        word[i] &= keepBits;
+      }
+    }
+  }
+
+  /************************************************************
+   * FUNCTION NAME: unrollRing
+   *
+   * This function rotates every word so that generation g lives
+   * in bit g again and keeps only the generations in keep. Needed
+   * before numberOfBFs changes as the ring mapping depends on it,
+   * the lazy clears are applied first for the same reason
+   *
+   * PARAMETERS:
+   *            ringSize: number of bits in the ring
+   *            keep: generations to keep after the rotation
+   *
+   * RETURNS: void
+   ************************************************************/
+  void unrollRing(unsigned int ringSize, unsigned long long int keep) {
+    catchUpAll();
+    if ( 0 == head ) {
+      clearBits(keep);
+      return;
+    }
+
+    for ( size_t line = 0; line < slices.size(); line++ ) {
+      slice_type *word = slices[line].word;
+      for ( unsigned int i = 0; i < wordsPerLine; i++ ) {
+        const unsigned long long int bits = word[i];
+        word[i] = static_cast<slice_type>(((bits >> head) | (bits << (ringSize - head))) & keep);
+      }
+    }
+    rotate(elementCount, elementCount + head, elementCount + ringSize);
+
+    head = 0;
+  }
+
+  /************************************************************
+   * FUNCTION NAME: fpp
+   *
+   * This function gives the FPP of one constituent BF holding
+   * count elements, as bloom_filter::effective_fpp() does
+   *
+   * RETURNS: (double) FPP
+   ************************************************************/
+  inline double fpp(unsigned long long int count) {
+    return pow(1.0 - exp(-1.0 * hashBF.hash_count() * count / hashBF.size()), 1.0 * hashBF.hash_count());
+  }
+
+}; // End of basicSlicedFBF class
+
+/*
+ * Bit sliced FBFs of up to 8, 16, 32 and 64 constituent BFs
+ */
+typedef basicSlicedFBF<unsigned char> slicedFBF8;
+typedef basicSlicedFBF<unsigned short> slicedFBF16;
+typedef basicSlicedFBF<unsigned int> slicedFBF32;
+typedef basicSlicedFBF<unsigned long long int> slicedFBF64;
+
+#endif
+
+/*
+ * EOF
+ */
@@ -5,6 +5,10 @@
 #include <unistd.h>
 #include  <stdio.h>
 #include <string.h>
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
 
 /*
  * Bloom Filter Library
@@ -16,6 +20,12 @@
  */
 //#include "FBF.cpp"
 #include "dynFBF.cpp"
+#include "slicedFBF.cpp"
+#include "fbfRegistry.cpp"
+#include "concurrentFBF.cpp"
+#include "shardedFBF.cpp"
+#include "deltaFBF.cpp"
+#include "refreshScheduler.cpp"
 
 /* 
  * Timer class
@@ -42,6 +52,8 @@
 #define ADD_INC_RR 1
 #define MUL_DEC_RR 2
 #define LONG_BUF_SZ 4096
+#define REGISTRY_CHECK_OPS 100
+#define SHARD_BATCH_SIZE 1024
 
 using namespace std;
 
@@ -81,9 +93,6 @@ void smartFBFvsDumbFBF(unsigned long long int numElements,
   cout<<" INFO :: REFRESH RATE: " <<refreshRate <<endl;
   cout<<" INFO :: BATCH OPERATIONS: " <<batchOps <<endl;
 
-  // Timer to refresh the constituent BFs in FBF
-  Timer t; 
-
   unsigned long long int i;
 
   /*
@@ -91,28 +100,17 @@ void smartFBFvsDumbFBF(unsigned long long int numElements,
    */
   dynFBF simpleFBF(4, tableSize, numOfHashes);
 
-  // Start the timer
-  t.start();
+  // Refresh the constituent BFs in FBF from a timer thread
+  std::mutex fbfMtx;
+  refreshScheduler scheduler(simpleFBF, refreshRate, &fbfMtx);
+  scheduler.start();
   cout<<" INFO :: Timer started " <<endl;
-  t.printStartTime();
 
   /* 
    * STEP 2: Insert some numbers into the FBF
    */
   for ( i = 0; i < numElements; i++ ) { 
 
-    /* 
-     * Check for elapsed time and refresh the FBF
-     */
-    if ( t.getElapsedTime() >= refreshRate ) { 
-      t.printElapsedTime();
-      cout<<endl<<endl<<"REFRESHING FBF"<<endl<<endl;
-      simpleFBF.refresh();
-      // Restart the timer
-      t.start();
-      t.printStartTime();
-    }
-      
     /*
      * For every batch operations done induce some
      * sleep time
@@ -124,9 +122,11 @@ void smartFBFvsDumbFBF(unsigned long long int numElements,
     /* 
      * Insert number into the FBF
      */
+    std::lock_guard<std::mutex> guard(fbfMtx);
     simpleFBF.insert(i);
 
   } // End of for that inserts elements into the FBF
+  scheduler.stop();
 
   /* 
    * STEP 3: Check for False Positives (FPs) using smart rules 
@@ -183,8 +183,6 @@ void refreshRateVsOpsPerSec(unsigned long long int numElements,
   cout<<" INFO :: REFRESH RATE: " <<refreshRate <<endl;
   cout<<" INFO :: BATCH OPERATIONS: " <<batchOps <<endl;
 
-  // Timer to refresh the constituent BFs in FBF
-  Timer t;
   // Timer to keep a tab on the operations per second
   Timer loopTime;
 
@@ -195,8 +193,10 @@ void refreshRateVsOpsPerSec(unsigned long long int numElements,
    */
   dynFBF simpleFBF(3, tableSize, numOfHashes);
 
-  // Start the timer
-  t.start();
+  // Refresh the constituent BFs in FBF from a timer thread
+  std::mutex fbfMtx;
+  refreshScheduler scheduler(simpleFBF, refreshRate, &fbfMtx);
+  scheduler.start();
   cout<<" INFO :: Timer started " <<endl;
 
   /* 
@@ -204,15 +204,6 @@ void refreshRateVsOpsPerSec(unsigned long long int numElements,
    */
   loopTime.start();
   for ( i = 0; i < numElements; i++ ) {
-    
-    /* 
-     * Check for elapsed time and refresh the FBF
-     */
-    if ( t.getElapsedTime() >= refreshRate ) {
-      simpleFBF.refresh();
-      // Restart the timer after the refresh
-      t.start();
-    }
 
     /*
      * For every batch operations done induce some 
@@ -225,6 +216,7 @@ void refreshRateVsOpsPerSec(unsigned long long int numElements,
     /* 
      * Insert number into the FBF 
      */
+    std::lock_guard<std::mutex> guard(fbfMtx);
     simpleFBF.insert(i);
 
   } // End of for that inserts elements into the FBF
@@ -233,128 +225,1222 @@ void refreshRateVsOpsPerSec(unsigned long long int numElements,
    * STEP 3: Measure the operations per second done
    */
   double elapsedLoopTime = loopTime.getElapsedTime();
+  scheduler.stop();
+  cout<<" INFO :: Time elapsed in for loop: " <<elapsedLoopTime <<endl;
+  cout<<" INFO :: Rate of insertion: " <<(double)numElements/elapsedLoopTime <<"per second" <<endl;
+
+  /* 
+   * STEP 4: Check for FPR using smart rules
+   */
+  //simpleFBF.checkSmartFBF_FPR(numberOfInvalids);
+
+  /*
+   * STEP 5: Check for FPR using mathematical probability
+   */
+  simpleFBF.checkEffectiveFPR();
+
+  cout<<" -----------------------------------------------------------" <<endl <<endl;
+
+}
+
+/******************************************************************************
+ * FUNCTION NAME: numberOfBFsVsOpsPerSec
+ * 
+ * This function maps the false positive rate for a given number of constituent
+ * number of BFs in the FBF and also keeps a tab on the operations per second
+ * 
+ * PARAMETERS: 
+ *            numberOfBFs: Number of constituent BFs in the FBF
+ *            numElements: Number of elements to be inserted into the
+ *                         FBF
+ *            tableSize: constituent BFs size i.e. number of bits 
+ *            numOfHashes: Number of hashes in each constituent BFs in 
+ *                         FBF
+ *            refreshRate: time in seconds after which the FBF is 
+ *                         refreshed
+ *            batchOps: number of inserts after which a sleep should be 
+ *                      induced to simulate real world scenario
+ *            numberOfInvalids: number of invalid membership checks to 
+ *                              be made
+ *
+ * RETURNS: void
+ ******************************************************************************/
+void numberOfBFsVsOpsPerSec(unsigned long numberOfBFs,
+                            unsigned long long int numElements, 
+                            unsigned long long int tableSize,
+		                    unsigned int numOfHashes,
+		                    unsigned long refreshRate,
+		                    unsigned long long int batchOps,
+		                    unsigned long long int numberOfInvalids) {
+
+  cout<<" ----------------------------------------------------------- " <<endl;
+  cout<<" INFO :: Test Execution Info " <<endl;
+  cout<<" INFO :: NUMBER OF ELEMENTS: " <<numElements <<endl;
+  // Table size and number of hash functions printed by compute_optimal function
+  // in FBF constructor. Number of BFs in FBF printed in constructor.
+  // Dont print here 
+  cout<<" INFO :: REFRESH RATE: " <<refreshRate <<endl;
+  cout<<" INFO :: BATCH OPERATIONS: " <<batchOps <<endl;
+
+  // Timer to keep a tab on the operations per second
+  Timer loopTime;
+
+  unsigned long long int i;
+
+  /*
+   * STEP 1: CREATE THE DYNAMIC FBF
+   */
+  dynFBF dyn_FBF(numberOfBFs, tableSize, numOfHashes);
+
+  // Refresh the constituent BFs in FBF from a timer thread
+  std::mutex fbfMtx;
+  refreshScheduler scheduler(dyn_FBF, refreshRate, &fbfMtx);
+  scheduler.start();
+  cout<<" INFO :: Timer started " <<endl;
+
+  /* 
+   * STEP 2: Insert some numbers in to the FBF
+   */
+  loopTime.start();
+  for ( i = 0; i < numElements; i++ ) {
+
+    /*
+     * For every batch operations done induce some 
+     * sleep time
+     */
+    if ( 0 == i% batchOps ) { 
+      sleep(SLEEP_TIME);
+    }
+
+    /* 
+     * Insert number into the FBF
+     */
+    std::lock_guard<std::mutex> guard(fbfMtx);
+    dyn_FBF.insert(i);
+
+  } // End of for that inserts elements into the FBF
+
+  /* 
+   * STEP 3: Measure the operations per second done 
+   */
+  double elapsedLoopTime = loopTime.getElapsedTime();
+  scheduler.stop();
   cout<<" INFO :: Time elapsed in for loop: " <<elapsedLoopTime <<endl;
   cout<<" INFO :: Rate of insertion: " <<(double)numElements/elapsedLoopTime <<"per second" <<endl;
 
-  /* 
-   * STEP 4: Check for FPR using smart rules
+  /*
+   * STEP 4: Check for FPR using smart rules
+   */
+  //dyn_FBF.checkSmartFBF_FPR(numberOfInvalids);
+
+  /*
+   * STEP 5: Check for probabilistic FPR
+   */
+  //t.printElapsedTime();
+  dyn_FBF.checkEffectiveFPR();
+
+  cout<<" -----------------------------------------------------------" <<endl <<endl;
+
+}
+
+/******************************************************************************
+ * FUNCTION NAME: constituentLayoutVsOpsPerSec
+ *
+ * This function measures the insert and smart query throughput of an FBF 
+ * built from a given constituent BF layout along with its false positive 
+ * rate. There is no sleep between the inserts and the FBF is refreshed 
+ * after every refreshOps inserts so that the runs are comparable
+ *
+ * PARAMETERS:
+ *            layout: name of the constituent BF layout being measured
+ *            numberOfBFs: Number of constituent BFs in the FBF
+ *            numElements: Number of elements to be inserted into the
+ *                         FBF
+ *            tableSize: constituent BFs size i.e. number of bits
+ *            numOfHashes: Number of hashes in each constituent BFs in
+ *                         FBF
+ *            refreshOps: number of inserts after which the FBF is 
+ *                        refreshed
+ *            numberOfInvalids: number of invalid membership checks to
+ *                              be made
+ *
+ * RETURNS: void
+ ******************************************************************************/
+template <typename fbf_type>
+void constituentLayoutVsOpsPerSec(const char *layout,
+                                  unsigned long numberOfBFs,
+                                  unsigned long long int numElements,
+                                  unsigned long long int tableSize,
+                                  unsigned int numOfHashes,
+                                  unsigned long long int refreshOps,
+                                  unsigned long long int numberOfInvalids) {
+
+  cout<<" ----------------------------------------------------------- " <<endl;
+  cout<<" INFO :: Test Execution Info " <<endl;
+  cout<<" INFO :: CONSTITUENT BF LAYOUT: " <<layout <<endl;
+  cout<<" INFO :: NUMBER OF ELEMENTS: " <<numElements <<endl;
+  cout<<" INFO :: REFRESH AFTER INSERTS: " <<refreshOps <<endl;
+
+  // Timer to keep a tab on the operations per second
+  Timer loopTime;
+
+  unsigned long long int i;
+
+  /*
+   * STEP 1: CREATE THE FBF
+   */
+  fbf_type fbf(numberOfBFs, tableSize, numOfHashes);
+
+  /*
+   * STEP 2: Insert some numbers into the FBF
+   */
+  loopTime.start();
+  for ( i = 0; i < numElements; i++ ) {
+    if ( 0 != i && 0 == i % refreshOps ) {
+      fbf.refresh();
+    }
+    fbf.insert(i);
+  }
+  double elapsedLoopTime = loopTime.getElapsedTime();
+  cout<<" RESULT :: " <<layout <<" insert rate: " <<(double)numElements/elapsedLoopTime <<" per second" <<endl;
+
+  /*
+   * STEP 3: Check for FPR using smart rules and measure the query rate
+   */
+  loopTime.start();
+  fbf.checkSmartFBF_FPR(numberOfInvalids);
+  elapsedLoopTime = loopTime.getElapsedTime();
+  cout<<" RESULT :: " <<layout <<" smart query rate: " <<(double)numberOfInvalids/elapsedLoopTime <<" per second" <<endl;
+
+  /*
+   * STEP 4: Check for probabilistic FPR
+   */
+  cout<<" RESULT :: " <<layout <<" effective FPR: " <<fbf.checkEffectiveFPR() <<endl;
+
+  cout<<" -----------------------------------------------------------" <<endl <<endl;
+
+}
+
+/******************************************************************************
+ * FUNCTION NAME: batchContainsVsOpsPerSec
+ *
+ * This function compares the lookup throughput of the per key contains()
+ * path with the batched contains_batch() path of a single constituent BF 
+ * on a negative heavy query stream. Build with -mavx2 to get the vector 
+ * kernel, otherwise both paths are scalar
+ *
+ * PARAMETERS:
+ *            tableSize: constituent BF size i.e. number of bits
+ *            numOfHashes: Number of hashes in the constituent BF
+ *            numElements: Number of elements to be inserted into the BF
+ *            numberOfQueries: Number of invalid membership checks to be 
+ *                             made
+ *
+ * RETURNS: void
+ ******************************************************************************/
+void batchContainsVsOpsPerSec(unsigned long long int tableSize,
+                              unsigned int numOfHashes,
+                              unsigned long long int numElements,
+                              unsigned long long int numberOfQueries) {
+
+  cout<<" ----------------------------------------------------------- " <<endl;
+  cout<<" INFO :: Test Execution Info " <<endl;
+  cout<<" INFO :: NUMBER OF ELEMENTS: " <<numElements <<endl;
+  cout<<" INFO :: NUMBER OF QUERIES: " <<numberOfQueries <<endl;
+
+  Timer loopTime;
+  unsigned long long int i;
+  unsigned long long int scalarFP = 0;
+  unsigned long long int batchFP = 0;
+
+  /*
+   * STEP 1: Create the BF and insert some numbers into it
+   */
+  bloom_parameters parameters;
+  parameters.random_seed = 0xA5A5A5A5;
+  parameters.compute_optimal_parameters(tableSize, numOfHashes);
+  bloom_filter bf(parameters);
+  for ( i = 0; i < numElements; i++ ) {
+    bf.insert(i);
+  }
+
+  vector<unsigned long long int> keys(numberOfQueries);
+  vector<unsigned long long int> bitmap((numberOfQueries + 63) / 64);
+  for ( i = 0; i < numberOfQueries; i++ ) {
+    keys[i] = numElements + i;
+  }
+
+  /*
+   * STEP 2: Per key lookups
+   */
+  loopTime.start();
+  for ( i = 0; i < numberOfQueries; i++ ) {
+    if ( bf.contains(keys[i]) ) {
+      scalarFP++;
+    }
+  }
+  double elapsedLoopTime = loopTime.getElapsedTime();
+  cout<<" RESULT :: per key lookup rate: " <<(double)numberOfQueries/elapsedLoopTime <<" per second" <<endl;
+
+  /*
+   * STEP 3: Batched lookups
+   */
+  loopTime.start();
+  bf.contains_batch(&keys[0], numberOfQueries, &bitmap[0]);
+  elapsedLoopTime = loopTime.getElapsedTime();
+  cout<<" RESULT :: batched lookup rate: " <<(double)numberOfQueries/elapsedLoopTime <<" per second" <<endl;
+
+  for ( i = 0; i < bitmap.size(); i++ ) {
+    batchFP += __builtin_popcountll(bitmap[i]);
+  }
+  cout<<" RESULT :: per key FP = " <<scalarFP <<"; batched FP = " <<batchFP <<endl;
+
+  cout<<" -----------------------------------------------------------" <<endl <<endl;
+
+}
+
+/******************************************************************************
+ * FUNCTION NAME: summaryFilterVsOpsPerSec
+ *
+ * This function measures the smart query throughput of an FBF with and 
+ * without the summary BFs on a stream of absent keys. Both FBFs get the 
+ * same inserts and are refreshed after every refreshOps inserts, which 
+ * should give at least numberOfBFs refreshes for the summaries to be used
+ *
+ * PARAMETERS:
+ *            numberOfBFs: Number of constituent BFs in the FBF
+ *            numElements: Number of elements to be inserted into the
+ *                         FBF
+ *            tableSize: constituent BFs size i.e. number of bits
+ *            numOfHashes: Number of hashes in each constituent BFs in
+ *                         FBF
+ *            refreshOps: number of inserts after which the FBF is 
+ *                        refreshed
+ *            numberOfInvalids: number of invalid membership checks to
+ *                              be made
+ *
+ * RETURNS: void
+ ******************************************************************************/
+void summaryFilterVsOpsPerSec(unsigned long numberOfBFs,
+                              unsigned long long int numElements,
+                              unsigned long long int tableSize,
+                              unsigned int numOfHashes,
+                              unsigned long long int refreshOps,
+                              unsigned long long int numberOfInvalids) {
+
+  cout<<" ----------------------------------------------------------- " <<endl;
+  cout<<" INFO :: Test Execution Info " <<endl;
+  cout<<" INFO :: NUMBER OF BFs: " <<numberOfBFs <<endl;
+  cout<<" INFO :: NUMBER OF ELEMENTS: " <<numElements <<endl;
+  cout<<" INFO :: NUMBER OF QUERIES: " <<numberOfInvalids <<endl;
+
+  Timer loopTime;
+  unsigned long long int i;
+
+  /*
+   * STEP 1: Create the FBFs and insert some numbers into them
+   */
+  dynFBF fbf(numberOfBFs, tableSize, numOfHashes);
+  dynFBF summaryFBF(numberOfBFs, tableSize, numOfHashes);
+  summaryFBF.enableSummary(TRUE);
+  loopTime.start();
+  for ( i = 0; i < numElements; i++ ) {
+    if ( 0 != i && 0 == i % refreshOps ) {
+      fbf.refresh();
+    }
+    fbf.insert(i);
+  }
+  double elapsedLoopTime = loopTime.getElapsedTime();
+  cout<<" RESULT :: insert rate without summary: " <<(double)numElements/elapsedLoopTime <<" per second" <<endl;
+
+  loopTime.start();
+  for ( i = 0; i < numElements; i++ ) {
+    if ( 0 != i && 0 == i % refreshOps ) {
+      summaryFBF.refresh();
+    }
+    summaryFBF.insert(i);
+  }
+  elapsedLoopTime = loopTime.getElapsedTime();
+  cout<<" RESULT :: insert rate with summary: " <<(double)numElements/elapsedLoopTime <<" per second" <<endl;
+
+  /*
+   * STEP 2: Smart queries walking the constituent BFs
+   */
+  loopTime.start();
+  fbf.checkSmartFBF_FPR(numberOfInvalids);
+  elapsedLoopTime = loopTime.getElapsedTime();
+  cout<<" RESULT :: smart query rate without summary: " <<(double)numberOfInvalids/elapsedLoopTime <<" per second" <<endl;
+
+  /*
+   * STEP 3: Smart queries through the summary BFs
+   */
+  loopTime.start();
+  summaryFBF.checkSmartFBF_FPR(numberOfInvalids);
+  elapsedLoopTime = loopTime.getElapsedTime();
+  cout<<" RESULT :: smart query rate with summary: " <<(double)numberOfInvalids/elapsedLoopTime <<" per second" <<endl;
+
+  cout<<" -----------------------------------------------------------" <<endl <<endl;
+
+}
+
+/******************************************************************************
+ * FUNCTION NAME: refreshLatencyVsTableSize
+ *
+ * This function measures the mean and worst refresh latency of an FBF and
+ * its insert rate. The recycled BF is cleared on the refresh path unless
+ * it is swapped for a pre-zeroed spare BF (spares > 0) or for a BF zeroed
+ * by the inserts (linesPerInsert > 0). A batch of inserts runs between two
+ * refreshes, giving the clearer thread or the inserts time to catch up
+ *
+ * PARAMETERS:
+ *            tableSize: constituent BFs size i.e. number of bits
+ *            numOfHashes: Number of hashes in each constituent BFs in
+ *                         FBF
+ *            numberOfRefreshes: Number of refreshes to be timed
+ *            refreshOps: number of inserts between two refreshes
+ *            spares: Number of pre-zeroed spare BFs
+ *            linesPerInsert: cache lines zeroed by each insert
+ *
+ * RETURNS: void
+ ******************************************************************************/
+template <typename fbf_type>
+void refreshLatencyVsTableSize(unsigned long long int tableSize,
+                               unsigned int numOfHashes,
+                               unsigned int numberOfRefreshes,
+                               unsigned long long int refreshOps,
+                               unsigned int spares,
+                               unsigned int linesPerInsert) {
+
+  cout<<" ----------------------------------------------------------- " <<endl;
+  cout<<" INFO :: Test Execution Info " <<endl;
+  cout<<" INFO :: TABLE SIZE: " <<tableSize <<endl;
+  cout<<" INFO :: NUMBER OF SPARES: " <<spares <<endl;
+  cout<<" INFO :: CACHE LINES CLEARED PER INSERT: " <<linesPerInsert <<endl;
+
+  Timer loopTime;
+  Timer insertTime;
+  double totalInsertTime = 0.0;
+  unsigned long long int element = 0;
+  double elapsedLoopTime = 0.0;
+  double totalRefreshTime = 0.0;
+  double maxRefreshTime = 0.0;
+
+  /*
+   * STEP 1: Create the FBF
+   */
+  fbf_type fbf(SIMPLE_FBF, tableSize, numOfHashes);
+  if ( 0 != spares ) {
+    fbf.enableBackgroundClearing(spares);
+  }
+  fbf.enableIncrementalClearing(linesPerInsert);
+
+  /*
+   * STEP 2: Insert and time every refresh
+   */
+  for ( unsigned int r = 0; r < numberOfRefreshes; r++ ) {
+    insertTime.start();
+    for ( unsigned long long int i = 0; i < refreshOps; i++ ) {
+      fbf.insert(element++);
+    }
+    totalInsertTime += insertTime.getElapsedTime();
+    loopTime.start();
+    fbf.refresh();
+    elapsedLoopTime = loopTime.getElapsedTime();
+    totalRefreshTime += elapsedLoopTime;
+    if ( elapsedLoopTime > maxRefreshTime ) {
+      maxRefreshTime = elapsedLoopTime;
+    }
+  }
+
+  cout<<" RESULT :: mean refresh latency: " <<totalRefreshTime/numberOfRefreshes <<" seconds" <<endl;
+  cout<<" RESULT :: max refresh latency: " <<maxRefreshTime <<" seconds" <<endl;
+  cout<<" RESULT :: insert rate: " <<(double)element/totalInsertTime <<" per second" <<endl;
+  cout<<" RESULT :: cells cleared by inserts: " <<fbf.insertClearedCells <<"; by refresh: " <<fbf.refreshClearedCells <<endl;
+  fbf.printArenaStats();
+
+  cout<<" -----------------------------------------------------------" <<endl <<endl;
+
+}
+
+/******************************************************************************
+ * FUNCTION NAME: registryVsOpsPerSec
+ *
+ * This function runs many FBFs, one per tenant, in one registry. The keys 
+ * are spread round robin over the tenants and the tenants are refreshed by 
+ * the registry with four different periods. The clock is the number of 
+ * inserts so far, the registry is checked every REGISTRY_CHECK_OPS inserts
+ *
+ * PARAMETERS:
+ *            numberOfFBFs: Number of FBFs in the registry
+ *            numElements: Number of elements to be inserted over all the 
+ *                         FBFs
+ *            tableSize: constituent BF size i.e. number of bits
+ *            numOfHashes: Number of hashes in each constituent BFs in FBF
+ *            refreshOps: shortest refresh period, in inserts
+ *
+ * RETURNS: void
+ ******************************************************************************/
+void registryVsOpsPerSec(unsigned int numberOfFBFs,
+                         unsigned long long int numElements,
+                         unsigned long long int tableSize,
+                         unsigned int numOfHashes,
+                         unsigned long long int refreshOps) {
+
+  cout<<" ----------------------------------------------------------- " <<endl;
+  cout<<" INFO :: Test Execution Info " <<endl;
+  cout<<" INFO :: NUMBER OF FBFs: " <<numberOfFBFs <<endl;
+  cout<<" INFO :: NUMBER OF ELEMENTS: " <<numElements <<endl;
+  cout<<" INFO :: REFRESH AFTER INSERTS: " <<refreshOps <<endl;
+
+  Timer loopTime;
+  unsigned long long int i;
+  unsigned long long int missing = 0;
+  fbfRegistry registry(REGISTRY_CHECK_OPS);
+
+  /*
+   * STEP 1: Create the FBFs
+   */
+  for ( unsigned int id = 0; id < numberOfFBFs; id++ ) {
+    registry.addFBF(SIMPLE_FBF, tableSize, numOfHashes, refreshOps * (1 + id % 4), 0);
+  }
+
+  /*
+   * STEP 2: Insert and let the registry refresh the FBFs
+   */
+  loopTime.start();
+  for ( i = 0; i < numElements; i++ ) {
+    registry.getFBF(i % numberOfFBFs).insert(i);
+    if ( 0 == (i + 1) % REGISTRY_CHECK_OPS ) {
+      registry.refreshExpired(i + 1);
+    }
+  }
+  double elapsedLoopTime = loopTime.getElapsedTime();
+
+  /*
+   * STEP 3: The last key of every FBF must still be in it
+   */
+  for ( i = numElements - numberOfFBFs; i < numElements; i++ ) {
+    if ( NOT_IN_FBF == registry.getFBF(i % numberOfFBFs).contains(i) ) {
+      missing++;
+    }
+  }
+
+  cout<<" RESULT :: " <<numberOfFBFs <<" FBFs insert rate: " <<(double)numElements/elapsedLoopTime <<" per second" <<endl;
+  cout<<" RESULT :: " <<numberOfFBFs <<" FBFs refreshes: " <<registry.refreshCount <<endl;
+  cout<<" RESULT :: " <<numberOfFBFs <<" FBFs memory: " <<registry.memoryUsage() <<" bytes" <<endl;
+  cout<<" RESULT :: " <<numberOfFBFs <<" FBFs missing recent keys: " <<missing <<endl;
+
+  cout<<" -----------------------------------------------------------" <<endl <<endl;
+
+}
+
+/******************************************************************************
+ * FUNCTION NAME: concurrentInsertVsThreads
+ *
+ * This function measures the aggregate insert and lookup rate of numThreads 
+ * threads sharing one FBF while another thread refreshes it every refreshMs 
+ * milliseconds. The lock free concurrentFBF is compared with a dynFBF behind 
+ * one mutex, as the April20 dynFBF did
+ *
+ * PARAMETERS:
+ *            numThreads: Number of inserting threads
+ *            numElements: Number of elements inserted and looked up by each 
+ *                         thread
+ *            tableSize: constituent BF size i.e. number of bits
+ *            numOfHashes: Number of hashes in each constituent BFs in FBF
+ *            refreshMs: refresh period in milliseconds
+ *
+ * RETURNS: void
+ ******************************************************************************/
+void concurrentInsertVsThreads(unsigned int numThreads,
+                               unsigned long long int numElements,
+                               unsigned long long int tableSize,
+                               unsigned int numOfHashes,
+                               unsigned int refreshMs) {
+
+  cout<<" ----------------------------------------------------------- " <<endl;
+  cout<<" INFO :: Test Execution Info " <<endl;
+  cout<<" INFO :: NUMBER OF THREADS: " <<numThreads <<endl;
+  cout<<" INFO :: NUMBER OF ELEMENTS PER THREAD: " <<numElements <<endl;
+  cout<<" INFO :: REFRESH PERIOD: " <<refreshMs <<" ms" <<endl;
+
+  Timer loopTime;
+  double elapsedLoopTime = 0.0;
+  std::atomic<bool> stop(false);
+  vector<std::thread> workers;
+  concurrentFBF lockFreeFBF(SIMPLE_FBF, tableSize, numOfHashes);
+  dynFBF lockedFBF(SIMPLE_FBF, tableSize, numOfHashes);
+  std::mutex lockedMtx;
+
+  /*
+   * STEP 1: Lock free FBF
+   */
+  std::thread refresher([&]() {
+    while ( !stop ) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(refreshMs));
+      lockFreeFBF.refresh();
+    }
+  });
+  loopTime.start();
+  for ( unsigned int t = 0; t < numThreads; t++ ) {
+    workers.push_back(std::thread([&, t]() {
+      int slot = lockFreeFBF.registerThread();
+      unsigned long long int base = (unsigned long long int) t << 40;
+      for ( unsigned long long int i = 0; i < numElements; i++ ) {
+        lockFreeFBF.insert(slot, base + i);
+        lockFreeFBF.contains(slot, base - i - 1);
+      }
+      lockFreeFBF.unregisterThread(slot);
+    }));
+  }
+  for ( unsigned int t = 0; t < numThreads; t++ ) {
+    workers[t].join();
+  }
+  elapsedLoopTime = loopTime.getElapsedTime();
+  stop = true;
+  refresher.join();
+  cout<<" RESULT :: lock free " <<numThreads <<" threads ops rate: " <<(2.0 * numElements * numThreads)/elapsedLoopTime <<" per second" <<endl;
+
+  /*
+   * STEP 2: dynFBF behind a mutex
+   */
+  stop = false;
+  workers.clear();
+  std::thread lockedRefresher([&]() {
+    while ( !stop ) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(refreshMs));
+      std::lock_guard<std::mutex> guard(lockedMtx);
+      lockedFBF.refresh();
+    }
+  });
+  loopTime.start();
+  for ( unsigned int t = 0; t < numThreads; t++ ) {
+    workers.push_back(std::thread([&, t]() {
+      unsigned long long int base = (unsigned long long int) t << 40;
+      for ( unsigned long long int i = 0; i < numElements; i++ ) {
+        {
+          std::lock_guard<std::mutex> guard(lockedMtx);
+          lockedFBF.insert(base + i);
+        }
+        std::lock_guard<std::mutex> guard(lockedMtx);
+        lockedFBF.contains(base - i - 1);
+      }
+    }));
+  }
+  for ( unsigned int t = 0; t < numThreads; t++ ) {
+    workers[t].join();
+  }
+  elapsedLoopTime = loopTime.getElapsedTime();
+  stop = true;
+  lockedRefresher.join();
+  cout<<" RESULT :: mutex " <<numThreads <<" threads ops rate: " <<(2.0 * numElements * numThreads)/elapsedLoopTime <<" per second" <<endl;
+
+  cout<<" -----------------------------------------------------------" <<endl <<endl;
+
+}
+
+/******************************************************************************
+ * FUNCTION NAME: shardedInsertVsThreads
+ *
+ * This function measures the aggregate insert rate of numThreads threads 
+ * sharing a sharded FBF with one shard per thread while another thread 
+ * refreshes it every refreshMs milliseconds. The keys are inserted one at a 
+ * time and in batches of SHARD_BATCH_SIZE, each shard holds 1/numThreads of 
+ * the bits so the total memory does not depend on the number of threads
+ *
+ * PARAMETERS:
+ *            numThreads: Number of inserting threads and of shards
+ *            numElements: Number of elements inserted by each thread
+ *            tableSize: total constituent BF size over all the shards
+ *            numOfHashes: Number of hashes in each constituent BFs in FBF
+ *            refreshMs: refresh period in milliseconds
+ *
+ * RETURNS: void
+ ******************************************************************************/
+void shardedInsertVsThreads(unsigned int numThreads,
+                            unsigned long long int numElements,
+                            unsigned long long int tableSize,
+                            unsigned int numOfHashes,
+                            unsigned int refreshMs) {
+
+  cout<<" ----------------------------------------------------------- " <<endl;
+  cout<<" INFO :: Test Execution Info " <<endl;
+  cout<<" INFO :: NUMBER OF THREADS: " <<numThreads <<endl;
+  cout<<" INFO :: NUMBER OF ELEMENTS PER THREAD: " <<numElements <<endl;
+  cout<<" INFO :: REFRESH PERIOD: " <<refreshMs <<" ms" <<endl;
+
+  Timer loopTime;
+  double elapsedLoopTime = 0.0;
+  std::atomic<bool> stop(false);
+  vector<std::thread> workers;
+  shardedFBF sFBF(numThreads, SIMPLE_FBF, tableSize / numThreads, numOfHashes);
+
+  std::thread refresher([&]() {
+    while ( !stop ) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(refreshMs));
+      sFBF.refresh();
+    }
+  });
+
+  /*
+   * STEP 1: One key at a time
+   */
+  loopTime.start();
+  for ( unsigned int t = 0; t < numThreads; t++ ) {
+    workers.push_back(std::thread([&, t]() {
+      unsigned long long int base = (unsigned long long int) t << 40;
+      for ( unsigned long long int i = 0; i < numElements; i++ ) {
+        sFBF.insert(base + i);
+      }
+    }));
+  }
+  for ( unsigned int t = 0; t < numThreads; t++ ) {
+    workers[t].join();
+  }
+  elapsedLoopTime = loopTime.getElapsedTime();
+  cout<<" RESULT :: sharded " <<numThreads <<" threads single insert rate: " <<(1.0 * numElements * numThreads)/elapsedLoopTime <<" per second" <<endl;
+
+  /*
+   * STEP 2: Batches sorted by shard
+   */
+  workers.clear();
+  loopTime.start();
+  for ( unsigned int t = 0; t < numThreads; t++ ) {
+    workers.push_back(std::thread([&, t]() {
+      unsigned long long int base = ((unsigned long long int) t << 40) + numElements;
+      vector<unsigned long long int> batch(SHARD_BATCH_SIZE);
+      for ( unsigned long long int i = 0; i < numElements; i += SHARD_BATCH_SIZE ) {
+        size_t count = 0;
+        for ( ; count < SHARD_BATCH_SIZE && i + count < numElements; count++ ) {
+          batch[count] = base + i + count;
+        }
+        sFBF.insert(&batch[0], count);
+      }
+    }));
+  }
+  for ( unsigned int t = 0; t < numThreads; t++ ) {
+    workers[t].join();
+  }
+  elapsedLoopTime = loopTime.getElapsedTime();
+  stop = true;
+  refresher.join();
+  cout<<" RESULT :: sharded " <<numThreads <<" threads batch insert rate: " <<(1.0 * numElements * numThreads)/elapsedLoopTime <<" per second" <<endl;
+
+  cout<<" -----------------------------------------------------------" <<endl <<endl;
+
+}
+
+/******************************************************************************
+ * FUNCTION NAME: deltaInsertVsThreads
+ *
+ * This function measures the aggregate insert rate of numThreads threads 
+ * inserting into one FBF while another thread refreshes it every refreshMs 
+ * milliseconds. The deltaFBF, whose writers insert into private deltas, is 
+ * compared with the per bit atomics of the concurrentFBF and with a dynFBF 
+ * behind one mutex
+ *
+ * PARAMETERS:
+ *            numThreads: Number of inserting threads
+ *            numElements: Number of elements inserted by each thread
+ *            tableSize: constituent BF size i.e. number of bits
+ *            numOfHashes: Number of hashes in each constituent BFs in FBF
+ *            refreshMs: refresh period in milliseconds
+ *
+ * RETURNS: void
+ ******************************************************************************/
+void deltaInsertVsThreads(unsigned int numThreads,
+                          unsigned long long int numElements,
+                          unsigned long long int tableSize,
+                          unsigned int numOfHashes,
+                          unsigned int refreshMs) {
+
+  cout<<" ----------------------------------------------------------- " <<endl;
+  cout<<" INFO :: Test Execution Info " <<endl;
+  cout<<" INFO :: NUMBER OF THREADS: " <<numThreads <<endl;
+  cout<<" INFO :: NUMBER OF ELEMENTS PER THREAD: " <<numElements <<endl;
+  cout<<" INFO :: REFRESH PERIOD: " <<refreshMs <<" ms" <<endl;
+
+  Timer loopTime;
+  double elapsedLoopTime = 0.0;
+  std::atomic<bool> stop(false);
+  vector<std::thread> workers;
+  deltaFBF dFBF(SIMPLE_FBF, tableSize, numOfHashes);
+  concurrentFBF atomicFBF(SIMPLE_FBF, tableSize, numOfHashes);
+  dynFBF lockedFBF(SIMPLE_FBF, tableSize, numOfHashes);
+  std::mutex lockedMtx;
+
+  /*
+   * STEP 1: Writer deltas
+   */
+  std::thread refresher([&]() {
+    while ( !stop ) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(refreshMs));
+      dFBF.refresh();
+    }
+  });
+  loopTime.start();
+  for ( unsigned int t = 0; t < numThreads; t++ ) {
+    workers.push_back(std::thread([&, t]() {
+      int slot = dFBF.registerWriter();
+      unsigned long long int base = (unsigned long long int) t << 40;
+      for ( unsigned long long int i = 0; i < numElements; i++ ) {
+        dFBF.insert(slot, base + i);
+      }
+      dFBF.unregisterWriter(slot);
+    }));
+  }
+  for ( unsigned int t = 0; t < numThreads; t++ ) {
+    workers[t].join();
+  }
+  elapsedLoopTime = loopTime.getElapsedTime();
+  stop = true;
+  refresher.join();
+  cout<<" RESULT :: delta " <<numThreads <<" threads insert rate: " <<(1.0 * numElements * numThreads)/elapsedLoopTime <<" per second" <<endl;
+  cout<<" RESULT :: delta " <<numThreads <<" threads merges: " <<dFBF.retMergeCount() <<endl;
+
+  /*
+   * STEP 2: Per bit atomics
+   */
+  stop = false;
+  workers.clear();
+  std::thread atomicRefresher([&]() {
+    while ( !stop ) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(refreshMs));
+      atomicFBF.refresh();
+    }
+  });
+  loopTime.start();
+  for ( unsigned int t = 0; t < numThreads; t++ ) {
+    workers.push_back(std::thread([&, t]() {
+      int slot = atomicFBF.registerThread();
+      unsigned long long int base = (unsigned long long int) t << 40;
+      for ( unsigned long long int i = 0; i < numElements; i++ ) {
+        atomicFBF.insert(slot, base + i);
+      }
+      atomicFBF.unregisterThread(slot);
+    }));
+  }
+  for ( unsigned int t = 0; t < numThreads; t++ ) {
+    workers[t].join();
+  }
+  elapsedLoopTime = loopTime.getElapsedTime();
+  stop = true;
+  atomicRefresher.join();
+  cout<<" RESULT :: atomic " <<numThreads <<" threads insert rate: " <<(1.0 * numElements * numThreads)/elapsedLoopTime <<" per second" <<endl;
+
+  /*
+   * STEP 3: dynFBF behind a mutex
+   */
+  stop = false;
+  workers.clear();
+  std::thread lockedRefresher([&]() {
+    while ( !stop ) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(refreshMs));
+      std::lock_guard<std::mutex> guard(lockedMtx);
+      lockedFBF.refresh();
+    }
+  });
+  loopTime.start();
+  for ( unsigned int t = 0; t < numThreads; t++ ) {
+    workers.push_back(std::thread([&, t]() {
+      unsigned long long int base = (unsigned long long int) t << 40;
+      for ( unsigned long long int i = 0; i < numElements; i++ ) {
+        std::lock_guard<std::mutex> guard(lockedMtx);
+        lockedFBF.insert(base + i);
+      }
+    }));
+  }
+  for ( unsigned int t = 0; t < numThreads; t++ ) {
+    workers[t].join();
+  }
+  elapsedLoopTime = loopTime.getElapsedTime();
+  stop = true;
+  lockedRefresher.join();
+  cout<<" RESULT :: mutex " <<numThreads <<" threads insert rate: " <<(1.0 * numElements * numThreads)/elapsedLoopTime <<" per second" <<endl;
+
+  cout<<" -----------------------------------------------------------" <<endl <<endl;
+
+}
+
+/******************************************************************************
+ * FUNCTION NAME: refreshSchedulerVsOpsPerSec
+ *
+ * This function measures the insert rate of a dynFBF refreshed every 
+ * refreshMs milliseconds, first by checking a Timer before every insert as 
+ * the benchmarks above used to, then by a refreshScheduler thread with the 
+ * inserts taking the FBF mutex. The refreshes done and the worst delay of 
+ * the scheduler after a deadline are reported
+ *
+ * PARAMETERS:
+ *            numElements: Number of elements to be inserted into the FBF
+ *            tableSize: constituent BF size i.e. number of bits
+ *            numOfHashes: Number of hashes in each constituent BFs in FBF
+ *            refreshMs: refresh period in milliseconds
+ *
+ * RETURNS: void
+ ******************************************************************************/
+void refreshSchedulerVsOpsPerSec(unsigned long long int numElements,
+                                 unsigned long long int tableSize,
+                                 unsigned int numOfHashes,
+                                 unsigned int refreshMs) {
+
+  cout<<" ----------------------------------------------------------- " <<endl;
+  cout<<" INFO :: Test Execution Info " <<endl;
+  cout<<" INFO :: NUMBER OF ELEMENTS: " <<numElements <<endl;
+  cout<<" INFO :: REFRESH PERIOD: " <<refreshMs <<" ms" <<endl;
+
+  Timer t;
+  Timer loopTime;
+  double elapsedLoopTime = 0.0;
+  double refreshRate = refreshMs / 1000.0;
+  unsigned long long int polledRefreshes = 0;
+  dynFBF polledFBF(SIMPLE_FBF, tableSize, numOfHashes);
+  dynFBF scheduledFBF(SIMPLE_FBF, tableSize, numOfHashes);
+
+  /*
+   * STEP 1: Clock checked on every insert
+   */
+  t.start();
+  loopTime.start();
+  for ( unsigned long long int i = 0; i < numElements; i++ ) {
+    if ( t.getElapsedTime() >= refreshRate ) {
+      polledFBF.refresh();
+      polledRefreshes++;
+      t.start();
+    }
+    polledFBF.insert(i);
+  }
+  elapsedLoopTime = loopTime.getElapsedTime();
+  cout<<" RESULT :: polled timer insert rate: " <<numElements/elapsedLoopTime <<" per second" <<endl;
+  cout<<" RESULT :: polled timer refreshes: " <<polledRefreshes <<" in " <<elapsedLoopTime <<" seconds" <<endl;
+
+  /*
+   * STEP 2: Refresh scheduler thread
+   */
+  std::mutex fbfMtx;
+  refreshScheduler scheduler(scheduledFBF, refreshRate, &fbfMtx);
+  scheduler.start();
+  loopTime.start();
+  for ( unsigned long long int i = 0; i < numElements; i++ ) {
+    std::lock_guard<std::mutex> guard(fbfMtx);
+    scheduledFBF.insert(i);
+  }
+  elapsedLoopTime = loopTime.getElapsedTime();
+  scheduler.stop();
+  cout<<" RESULT :: scheduler insert rate: " <<numElements/elapsedLoopTime <<" per second" <<endl;
+  cout<<" RESULT :: scheduler refreshes: " <<scheduler.retRefreshCount() <<" in " <<elapsedLoopTime <<" seconds" <<endl;
+  cout<<" RESULT :: scheduler max lateness: " <<scheduler.retMaxLateness() * 1000.0 <<" ms" <<endl;
+
+  cout<<" -----------------------------------------------------------" <<endl <<endl;
+
+}
+
+/******************************************************************************
+ * FUNCTION NAME: registryStaggerVsBurst
+ *
+ * This function runs numberOfFBFs FBFs with the same refresh period in one 
+ * registry, driven by a single thread calling refreshExpired() every 
+ * millisecond of a simulated clock for numPeriods periods. It reports the 
+ * most refreshes done in one call and the slowest call, ie the burst of 
+ * table clears, with and without a stagger window of one period, and the 
+ * cost of a call refreshing nothing next to a scan of every deadline
+ *
+ * PARAMETERS:
+ *            numberOfFBFs: Number of FBFs in the registry
+ *            tableSize: constituent BF size i.e. number of bits
+ *            numOfHashes: Number of hashes in each constituent BFs in FBF
+ *            periodMs: refresh period of every FBF in milliseconds
+ *            numPeriods: number of periods simulated
+ *            stagger: TRUE to spread the deadlines over a period
+ *
+ * RETURNS: void
+ ******************************************************************************/
+void registryStaggerVsBurst(unsigned int numberOfFBFs,
+                            unsigned long long int tableSize,
+                            unsigned int numOfHashes,
+                            unsigned int periodMs,
+                            unsigned int numPeriods,
+                            bool stagger) {
+
+  cout<<" ----------------------------------------------------------- " <<endl;
+  cout<<" INFO :: Test Execution Info " <<endl;
+  cout<<" INFO :: NUMBER OF FBFs: " <<numberOfFBFs <<endl;
+  cout<<" INFO :: REFRESH PERIOD: " <<periodMs <<" ms" <<endl;
+  cout<<" INFO :: STAGGER: " <<stagger <<endl;
+
+  const char *label = stagger ? "staggered" : "aligned";
+  Timer callTime;
+  double elapsedCallTime = 0.0;
+  double slowestCall = 0.0;
+  double idleCallTime = 0.0;
+  unsigned long long int calls = 0;
+  unsigned long long int idleCalls = 0;
+  unsigned long long int key = 0;
+  fbfRegistry registry(0.001);
+
+  /*
+   * STEP 1: Create the FBFs, all with the same period
+   */
+  if ( stagger ) {
+    registry.setStagger(periodMs / 1000.0);
+  }
+  for ( unsigned int id = 0; id < numberOfFBFs; id++ ) {
+    registry.addFBF(SIMPLE_FBF, tableSize, numOfHashes, periodMs / 1000.0, 0);
+  }
+
+  /*
+   * STEP 2: One thread inserts and refreshes, one call per ms
+   */
+  for ( unsigned int ms = 1; ms <= periodMs * numPeriods; ms++ ) {
+    for ( unsigned int op = 0; op < numberOfFBFs; op++, key++ ) {
+      registry.getFBF(key % numberOfFBFs).insert(key);
+    }
+    callTime.start();
+    unsigned int refreshed = registry.refreshExpired(ms / 1000.0);
+    elapsedCallTime = callTime.getElapsedTime();
+    if ( 0 == refreshed ) {
+      idleCallTime += elapsedCallTime;
+      idleCalls++;
+    }
+    if ( elapsedCallTime > slowestCall ) {
+      slowestCall = elapsedCallTime;
+    }
+    calls++;
+  }
+
+  /*
+   * STEP 3: Cost of scanning every deadline once per call, as the
+   *         registry did before the timer wheel
+   */
+  unsigned long long int due = 0;
+  callTime.start();
+  for ( unsigned long long int call = 0; call < calls; call++ ) {
+    for ( unsigned int id = 0; id < numberOfFBFs; id++ ) {
+      if ( registry.nextRefresh[id] <= (double) call / 1000.0 ) {
+        due++;
+      }
+    }
+  }
+  double scanTime = callTime.getElapsedTime();
+
+  cout<<" RESULT :: " <<label <<" " <<numberOfFBFs <<" FBFs refreshes: " <<registry.refreshCount <<endl;
+  cout<<" RESULT :: " <<label <<" " <<numberOfFBFs <<" FBFs max refreshes per call: " <<registry.maxRefreshBurst <<endl;
+  cout<<" RESULT :: " <<label <<" " <<numberOfFBFs <<" FBFs slowest call: " <<slowestCall * 1000.0 <<" ms" <<endl;
+  cout<<" RESULT :: " <<label <<" " <<numberOfFBFs <<" FBFs mean call refreshing nothing: " <<idleCallTime * 1000000.0 / (idleCalls ? idleCalls : 1) <<" us (" <<idleCalls <<" calls)" <<endl;
+  cout<<" RESULT :: " <<label <<" " <<numberOfFBFs <<" FBFs mean deadline scan: " <<scanTime * 1000000.0 / calls <<" us (" <<due <<" due)" <<endl;
+
+  cout<<" -----------------------------------------------------------" <<endl <<endl;
+
+}
+
+/******************************************************************************
+ * FUNCTION NAME: constituentBFVsOpsPerSec
+ *
+ * This function measures the insert and lookup throughput and the false 
+ * positive rate of a constituent BF for a given set of bloom parameters, 
+ * e.g. the hash mode or the index mode
+ *
+ * PARAMETERS:
+ *            label: name of the configuration being measured
+ *            parameters: bloom parameters of the constituent BF
+ *            tableSize: constituent BF size i.e. number of bits
+ *            numOfHashes: Number of hashes in the constituent BF
+ *            numElements: Number of elements to be inserted into the BF
+ *            numberOfQueries: Number of invalid membership checks to be 
+ *                             made
+ *
+ * RETURNS: void
+ ******************************************************************************/
+void constituentBFVsOpsPerSec(const char *label,
+                              bloom_parameters parameters,
+                              unsigned long long int tableSize,
+                              unsigned int numOfHashes,
+                              unsigned long long int numElements,
+                              unsigned long long int numberOfQueries) {
+
+  cout<<" ----------------------------------------------------------- " <<endl;
+  cout<<" INFO :: Test Execution Info " <<endl;
+  cout<<" INFO :: CONFIGURATION: " <<label <<endl;
+  cout<<" INFO :: NUMBER OF ELEMENTS: " <<numElements <<endl;
+  cout<<" INFO :: NUMBER OF QUERIES: " <<numberOfQueries <<endl;
+
+  Timer loopTime;
+  unsigned long long int i;
+  unsigned long long int FP = 0;
+
+  parameters.compute_optimal_parameters(tableSize, numOfHashes);
+  bloom_filter bf(parameters);
+
+  /*
+   * STEP 1: Insert some numbers into the BF
    */
-  //simpleFBF.checkSmartFBF_FPR(numberOfInvalids);
+  loopTime.start();
+  for ( i = 0; i < numElements; i++ ) {
+    bf.insert(i);
+  }
+  double elapsedLoopTime = loopTime.getElapsedTime();
+  cout<<" RESULT :: " <<label <<" k = " <<numOfHashes <<" insert rate: " <<(double)numElements/elapsedLoopTime <<" per second" <<endl;
 
   /*
-   * STEP 5: Check for FPR using mathematical probability
+   * STEP 2: Invalid membership checks
    */
-  simpleFBF.checkEffectiveFPR();
+  loopTime.start();
+  for ( i = numElements; i < numElements + numberOfQueries; i++ ) {
+    if ( bf.contains(i) ) {
+      FP++;
+    }
+  }
+  elapsedLoopTime = loopTime.getElapsedTime();
+  cout<<" RESULT :: " <<label <<" k = " <<numOfHashes <<" lookup rate: " <<(double)numberOfQueries/elapsedLoopTime <<" per second" <<endl;
+  cout<<" RESULT :: " <<label <<" k = " <<numOfHashes <<" FPR = " <<(double)FP/numberOfQueries <<"; effective FPR = " <<bf.effective_fpp() <<endl;
 
   cout<<" -----------------------------------------------------------" <<endl <<endl;
 
 }
 
 /******************************************************************************
- * FUNCTION NAME: numberOfBFsVsOpsPerSec
- * 
- * This function maps the false positive rate for a given number of constituent
- * number of BFs in the FBF and also keeps a tab on the operations per second
- * 
- * PARAMETERS: 
- *            numberOfBFs: Number of constituent BFs in the FBF
- *            numElements: Number of elements to be inserted into the
- *                         FBF
- *            tableSize: constituent BFs size i.e. number of bits 
- *            numOfHashes: Number of hashes in each constituent BFs in 
- *                         FBF
- *            refreshRate: time in seconds after which the FBF is 
- *                         refreshed
- *            batchOps: number of inserts after which a sleep should be 
- *                      induced to simulate real world scenario
- *            numberOfInvalids: number of invalid membership checks to 
- *                              be made
+ * FUNCTION NAME: openTlbMissCounter
+ *
+ * This function opens a hardware counter of the data TLB read misses of 
+ * this thread in user space
+ *
+ * RETURNS: file descriptor of the counter, -1 if there is no such counter
+ ******************************************************************************/
+int openTlbMissCounter() {
+#if defined(__linux__)
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HW_CACHE;
+  attr.config = PERF_COUNT_HW_CACHE_DTLB | 
+                (PERF_COUNT_HW_CACHE_OP_READ << 8) | 
+                (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#else
+  return FAILURE;
+#endif
+}
+
+/******************************************************************************
+ * FUNCTION NAME: readTlbMissCounter
+ *
+ * This function reads the counter opened by openTlbMissCounter
+ *
+ * RETURNS: number of misses so far, 0 if there is no counter
+ ******************************************************************************/
+unsigned long long int readTlbMissCounter(int fd) {
+  unsigned long long int misses = 0;
+  if ( FAILURE == fd || sizeof(misses) != read(fd, &misses, sizeof(misses)) ) {
+    return 0;
+  }
+  return misses;
+}
+
+/******************************************************************************
+ * FUNCTION NAME: anonHugePagesKB
+ *
+ * This function returns how much of the anonymous memory of the process is 
+ * backed by transparent huge pages
+ *
+ * RETURNS: AnonHugePages in kB, 0 if unknown
+ ******************************************************************************/
+unsigned long long int anonHugePagesKB() {
+  unsigned long long int kB = 0;
+  char line[LONG_BUF_SZ];
+  FILE *smaps = fopen("/proc/self/smaps_rollup", "r");
+  if ( NULL == smaps ) {
+    return 0;
+  }
+  while ( NULL != fgets(line, sizeof(line), smaps) ) {
+    if ( 1 == sscanf(line, "AnonHugePages: %llu kB", &kB) ) {
+      break;
+    }
+  }
+  fclose(smaps);
+  return kB;
+}
+
+/******************************************************************************
+ * FUNCTION NAME: pageModeVsOpsPerSec
+ *
+ * This function measures the insert and lookup throughput and the data TLB 
+ * misses of a large constituent BF backed by standard or huge pages
+ *
+ * PARAMETERS:
+ *            label: name of the page mode being measured
+ *            pageMode: how the bit table is backed
+ *            tableSize: constituent BF size i.e. number of bits
+ *            numOfHashes: Number of hashes in the constituent BF
+ *            numElements: Number of elements to be inserted into the BF
+ *            numberOfQueries: Number of invalid membership checks to be 
+ *                             made
  *
  * RETURNS: void
  ******************************************************************************/
-void numberOfBFsVsOpsPerSec(unsigned long numberOfBFs,
-                            unsigned long long int numElements, 
-                            unsigned long long int tableSize,
-		                    unsigned int numOfHashes,
-		                    unsigned long refreshRate,
-		                    unsigned long long int batchOps,
-		                    unsigned long long int numberOfInvalids) {
+void pageModeVsOpsPerSec(const char *label,
+                         bloom_parameters::page_mode_t pageMode,
+                         unsigned long long int tableSize,
+                         unsigned int numOfHashes,
+                         unsigned long long int numElements,
+                         unsigned long long int numberOfQueries) {
 
   cout<<" ----------------------------------------------------------- " <<endl;
   cout<<" INFO :: Test Execution Info " <<endl;
+  cout<<" INFO :: PAGE MODE: " <<label <<endl;
   cout<<" INFO :: NUMBER OF ELEMENTS: " <<numElements <<endl;
-  // Table size and number of hash functions printed by compute_optimal function
-  // in FBF constructor. Number of BFs in FBF printed in constructor.
-  // Dont print here 
-  cout<<" INFO :: REFRESH RATE: " <<refreshRate <<endl;
-  cout<<" INFO :: BATCH OPERATIONS: " <<batchOps <<endl;
+  cout<<" INFO :: NUMBER OF QUERIES: " <<numberOfQueries <<endl;
 
-  // Timer to refresh the constituent BFs in FBF
-  Timer t;
-  // Timer to keep a tab on the operations per second
   Timer loopTime;
-
   unsigned long long int i;
+  unsigned long long int FP = 0;
+  unsigned long long int misses = 0;
+  int tlbCounter = openTlbMissCounter();
+  bloom_parameters parameters;
 
-  /*
-   * STEP 1: CREATE THE DYNAMIC FBF
-   */
-  dynFBF dyn_FBF(numberOfBFs, tableSize, numOfHashes);
-
-  // Start the timer
-  t.start();
-  cout<<" INFO :: Timer started " <<endl;
-  //t.printStartTime();
+  parameters.random_seed = 0xA5A5A5A5;
+  parameters.page_mode = pageMode;
+  parameters.compute_optimal_parameters(tableSize, numOfHashes);
+  bloom_filter bf(parameters);
 
-  /* 
-   * STEP 2: Insert some numbers in to the FBF
+  /*
+   * STEP 1: Insert some numbers into the BF
    */
+  misses = readTlbMissCounter(tlbCounter);
   loopTime.start();
   for ( i = 0; i < numElements; i++ ) {
-
-    /* 
-     * Check for elapsed time and refresh the FBF
-     */
-    if ( t.getElapsedTime() >= refreshRate ) {
-      //t.printElapsedTime();
-      dyn_FBF.refresh();
-      // Restart the timer after the refresh
-      t.start();
-      //t.printStartTime();
-    }
-
-    /*
-     * For every batch operations done induce some 
-     * sleep time
-     */
-    if ( 0 == i% batchOps ) { 
-      sleep(SLEEP_TIME);
-    }
-
-    /* 
-     * Insert number into the FBF
-     */
-    dyn_FBF.insert(i);
-
-  } // End of for that inserts elements into the FBF
-
-  /* 
-   * STEP 3: Measure the operations per second done 
-   */
+    bf.insert(i);
+  }
   double elapsedLoopTime = loopTime.getElapsedTime();
-  cout<<" INFO :: Time elapsed in for loop: " <<elapsedLoopTime <<endl;
-  cout<<" INFO :: Rate of insertion: " <<(double)numElements/elapsedLoopTime <<"per second" <<endl;
-
-  /*
-   * STEP 4: Check for FPR using smart rules
-   */
-  //dyn_FBF.checkSmartFBF_FPR(numberOfInvalids);
+  misses = readTlbMissCounter(tlbCounter) - misses;
+  cout<<" RESULT :: " <<label <<" insert rate: " <<(double)numElements/elapsedLoopTime <<" per second" <<endl;
+  if ( FAILURE != tlbCounter ) {
+    cout<<" RESULT :: " <<label <<" dTLB misses per insert: " <<(double)misses/numElements <<endl;
+  }
 
   /*
-   * STEP 5: Check for probabilistic FPR
+   * STEP 2: Invalid membership checks
    */
-  //t.printElapsedTime();
-  dyn_FBF.checkEffectiveFPR();
+  misses = readTlbMissCounter(tlbCounter);
+  loopTime.start();
+  for ( i = numElements; i < numElements + numberOfQueries; i++ ) {
+    if ( bf.contains(i) ) {
+      FP++;
+    }
+  }
+  elapsedLoopTime = loopTime.getElapsedTime();
+  misses = readTlbMissCounter(tlbCounter) - misses;
+  cout<<" RESULT :: " <<label <<" lookup rate: " <<(double)numberOfQueries/elapsedLoopTime <<" per second" <<endl;
+  if ( FAILURE != tlbCounter ) {
+    cout<<" RESULT :: " <<label <<" dTLB misses per lookup: " <<(double)misses/numberOfQueries <<endl;
+    close(tlbCounter);
+  }
+  else {
+    cout<<" RESULT :: " <<label <<" dTLB misses: no hardware counter available" <<endl;
+  }
+  cout<<" RESULT :: " <<label <<" AnonHugePages: " <<anonHugePagesKB() <<" kB" <<endl;
+  cout<<" RESULT :: " <<label <<" FPR = " <<(double)FP/numberOfQueries <<endl;
 
   cout<<" -----------------------------------------------------------" <<endl <<endl;
 
@@ -437,6 +1523,7 @@ void dynamicResizing(double targetFPR, char fileName[LONG_BUF_SZ]) {
 	    cout<<" RESULTS :: FPR: "  <<currentFPR <<"; ops per second : " <<i/(loopTime.getElapsedTime()) <<"\n";
 	    cout<<" RESULTS :: ELAPSED TIME: " <<loopTime.getElapsedTime() <<endl;
 	    cout<<" RESULTS :: FBF state: NumOfBFs: " <<drFBF.retNumOfBFs() <<"; Refresh Rate: " <<refreshRate <<"\n\n";
+	    drFBF.printArenaStats();
 	  }
 	}
 	else if( currentFPR <= 0.5 * targetFPR ) {
@@ -450,6 +1537,7 @@ void dynamicResizing(double targetFPR, char fileName[LONG_BUF_SZ]) {
 		  cout<<" RESULTS :: FPR: "  <<currentFPR <<"; ops per second : " <<i/(loopTime.getElapsedTime()) <<"\n";
 		  cout<<" RESULTS :: ELAPSED TIME: " <<loopTime.getElapsedTime() <<endl;
 		  cout<<" RESULTS :: FBF state: NumOfBFs: " <<drFBF.retNumOfBFs() <<"; Refresh Rate: " <<refreshRate <<"\n\n";
+		  drFBF.printArenaStats();
 	  }
 	  //cout<<endl<<"Refresh rate: " <<refreshRate<<endl;
 	}
@@ -530,6 +1618,7 @@ void dynamicResizing(double targetFPR, char fileName[LONG_BUF_SZ]) {
 
   } // End of for that inserts elements into the FBF
 
+  drFBF.printArenaStats();
   cout<<" -----------------------------------------------------------" <<endl <<endl;
 
 } // End of dynamicResizing()
@@ -725,6 +1814,314 @@ void varyConstituentBFNumbers() {
 
 }
 
+/******************************************************************************
+ * FUNCTION NAME: varyConstituentLayout
+ *
+ * This function compares the classic constituent BF layout with the cache
+ * line blocked layouts for growing constituent BF sizes. Once the tables no 
+ * longer fit in the cache the blocked layout needs one cache miss per 
+ * constituent BF instead of one per hash function. The epoch tagged 
+ * layout adds a lookup of the block tag but makes refresh constant time
+ *
+ * RETURNS: void
+ ******************************************************************************/
+void varyConstituentLayout() {
+  unsigned long long int num = 4000000;
+  unsigned long long int inv = 2000000;
+  unsigned int numHashes = 7;
+  unsigned long bf = 4;
+
+  for ( unsigned long long int tableSize = 1ULL << 20; tableSize <= (1ULL << 28); tableSize <<= 2 ) {
+    constituentLayoutVsOpsPerSec<dynFBF>("classic", bf, num, tableSize, numHashes, num / bf, inv);
+    constituentLayoutVsOpsPerSec<blockedDynFBF>("blocked", bf, num, tableSize, numHashes, num / bf, inv);
+    constituentLayoutVsOpsPerSec<epochDynFBF>("epoch tagged", bf, num, tableSize, numHashes, num / bf, inv);
+  }
+}
+
+/******************************************************************************
+ * FUNCTION NAME: varySlicedFBF
+ *
+ * This function compares the dynamic FBF with the bit sliced FBF for growing
+ * number of constituent BFs. The sliced FBF costs k memory accesses per 
+ * insert and query whatever the number of constituent BFs
+ *
+ * RETURNS: void
+ ******************************************************************************/
+void varySlicedFBF() {
+  unsigned long long int num = 4000000;
+  unsigned long long int inv = 2000000;
+  unsigned long long int tableSize = 1ULL << 20;
+  unsigned int numHashes = 7;
+
+  for ( unsigned long bf = 3; bf <= slicedFBF64::maxNumberOfBFs; bf *= 2 ) {
+    constituentLayoutVsOpsPerSec<dynFBF>("dynamic", bf, num, tableSize, numHashes, num / bf, inv);
+    if ( bf <= slicedFBF8::maxNumberOfBFs ) {
+      constituentLayoutVsOpsPerSec<slicedFBF8>("sliced 8", bf, num, tableSize, numHashes, num / bf, inv);
+    }
+    else if ( bf <= slicedFBF16::maxNumberOfBFs ) {
+      constituentLayoutVsOpsPerSec<slicedFBF16>("sliced 16", bf, num, tableSize, numHashes, num / bf, inv);
+    }
+    else if ( bf <= slicedFBF32::maxNumberOfBFs ) {
+      constituentLayoutVsOpsPerSec<slicedFBF32>("sliced 32", bf, num, tableSize, numHashes, num / bf, inv);
+    }
+    else {
+      constituentLayoutVsOpsPerSec<slicedFBF64>("sliced 64", bf, num, tableSize, numHashes, num / bf, inv);
+    }
+  }
+}
+
+/******************************************************************************
+ * FUNCTION NAME: varySummaryFilter
+ *
+ * This function runs the summary BF comparison for growing number of 
+ * constituent BFs, doubling them as triggerDynamicResizing() does
+ *
+ * RETURNS: void
+ ******************************************************************************/
+void varySummaryFilter() {
+  unsigned long long int num = 2000000;
+  unsigned long long int inv = 2000000;
+  unsigned long long int tableSize = 1ULL << 20;
+  unsigned int numHashes = 7;
+
+  for ( unsigned long bf = 3; bf <= 96; bf *= 2 ) {
+    summaryFilterVsOpsPerSec(bf, num, tableSize, numHashes, num / (2 * bf), inv);
+  }
+}
+
+/******************************************************************************
+ * FUNCTION NAME: varyConcurrentThreads
+ *
+ * This function runs the concurrent FBF comparison from 1 thread up to one 
+ * thread per core, doubling the threads
+ *
+ * RETURNS: void
+ ******************************************************************************/
+void varyConcurrentThreads() {
+  unsigned long long int tableSize = 1ULL << 24;
+  unsigned long long int num = 2000000;
+  unsigned int cores = std::thread::hardware_concurrency();
+
+  if ( 0 == cores ) {
+    cores = 1;
+  }
+  for ( unsigned int threads = 1; threads < cores; threads *= 2 ) {
+    concurrentInsertVsThreads(threads, num, tableSize, 3, 100);
+  }
+  concurrentInsertVsThreads(cores, num, tableSize, 3, 100);
+}
+
+/******************************************************************************
+ * FUNCTION NAME: varyShardedFBF
+ *
+ * This function runs the sharded FBF from 1 thread up to one thread per 
+ * core, doubling the threads
+ *
+ * RETURNS: void
+ ******************************************************************************/
+void varyShardedFBF() {
+  unsigned long long int tableSize = 1ULL << 24;
+  unsigned long long int num = 2000000;
+  unsigned int cores = std::thread::hardware_concurrency();
+
+  if ( 0 == cores ) {
+    cores = 1;
+  }
+  for ( unsigned int threads = 1; threads < cores; threads *= 2 ) {
+    shardedInsertVsThreads(threads, num, tableSize, 3, 100);
+  }
+  shardedInsertVsThreads(cores, num, tableSize, 3, 100);
+}
+
+/******************************************************************************
+ * FUNCTION NAME: varyDeltaWriters
+ *
+ * This function runs the writer delta comparison from 1 thread up to one 
+ * thread per core, doubling the threads
+ *
+ * RETURNS: void
+ ******************************************************************************/
+void varyDeltaWriters() {
+  unsigned long long int tableSize = 1ULL << 24;
+  unsigned long long int num = 2000000;
+  unsigned int cores = std::thread::hardware_concurrency();
+
+  if ( 0 == cores ) {
+    cores = 1;
+  }
+  for ( unsigned int threads = 1; threads < cores; threads *= 2 ) {
+    deltaInsertVsThreads(threads, num, tableSize, 3, 100);
+  }
+  deltaInsertVsThreads(cores, num, tableSize, 3, 100);
+}
+
+/******************************************************************************
+ * FUNCTION NAME: varyRefreshScheduler
+ *
+ * This function compares the polled timer and the refresh scheduler for 
+ * refresh periods of 10ms, 100ms and 1s
+ *
+ * RETURNS: void
+ ******************************************************************************/
+void varyRefreshScheduler() {
+  unsigned long long int tableSize = 1ULL << 24;
+  unsigned long long int num = 20000000;
+
+  for ( unsigned int refreshMs = 10; refreshMs <= 1000; refreshMs *= 10 ) {
+    refreshSchedulerVsOpsPerSec(num, tableSize, 3, refreshMs);
+  }
+}
+
+/******************************************************************************
+ * FUNCTION NAME: varyRefreshStagger
+ *
+ * This function runs 100, 1000 and 10000 FBFs with the same 100ms refresh 
+ * period, with the deadlines aligned and staggered
+ *
+ * RETURNS: void
+ ******************************************************************************/
+void varyRefreshStagger() {
+  unsigned long long int tableSize = 1ULL << 18;
+
+  for ( unsigned int numberOfFBFs = 100; numberOfFBFs <= 10000; numberOfFBFs *= 10 ) {
+    registryStaggerVsBurst(numberOfFBFs, tableSize, 3, 100, 3, false);
+    registryStaggerVsBurst(numberOfFBFs, tableSize, 3, 100, 3, true);
+  }
+}
+
+/******************************************************************************
+ * FUNCTION NAME: varyRegistrySize
+ *
+ * This function runs 1, 10, 100 and 1000 FBFs in one registry with the same
+ * total number of inserts, the refresh periods are counted over all of them
+ *
+ * RETURNS: void
+ ******************************************************************************/
+void varyRegistrySize() {
+  unsigned long long int tableSize = 1ULL << 16;
+  unsigned long long int num = 10000000;
+
+  for ( unsigned int numberOfFBFs = 1; numberOfFBFs <= 1000; numberOfFBFs *= 10 ) {
+    registryVsOpsPerSec(numberOfFBFs, num, tableSize, 3, 100000);
+  }
+}
+
+/******************************************************************************
+ * FUNCTION NAME: varyRefreshLatency
+ *
+ * This function compares the refresh latency when clearing on the refresh
+ * path, with background clearing, with incremental clearing and with epoch
+ * tagged constituent BFs for growing constituent BF sizes. 4 cache lines
+ * per insert clear a 2^28 bit table within the 1000000 inserts of a refresh
+ * period
+ *
+ * RETURNS: void
+ ******************************************************************************/
+void varyRefreshLatency() {
+  unsigned int numHashes = 7;
+  unsigned int refreshes = 20;
+
+  for ( unsigned long long int tableSize = 1ULL << 20; tableSize <= (1ULL << 30); tableSize <<= 2 ) {
+    refreshLatencyVsTableSize<dynFBF>(tableSize, numHashes, refreshes, 1000000, 0, 0);
+    refreshLatencyVsTableSize<dynFBF>(tableSize, numHashes, refreshes, 1000000, 1, 0);
+    refreshLatencyVsTableSize<dynFBF>(tableSize, numHashes, refreshes, 1000000, 0, 4);
+    refreshLatencyVsTableSize<epochDynFBF>(tableSize, numHashes, refreshes, 1000000, 0, 0);
+  }
+}
+
+/******************************************************************************
+ * FUNCTION NAME: varyBatchContains
+ *
+ * This function runs the per key vs batched lookup comparison for growing
+ * constituent BF sizes and number of hashes
+ *
+ * RETURNS: void
+ ******************************************************************************/
+void varyBatchContains() {
+  unsigned long long int queries = 10000000;
+
+  for ( unsigned long long int tableSize = 1ULL << 20; tableSize <= (1ULL << 28); tableSize <<= 4 ) {
+    for ( unsigned int numHashes = 3; numHashes < 10; numHashes += 2 ) {
+      batchContainsVsOpsPerSec(tableSize, numHashes, tableSize / 16, queries);
+    }
+  }
+}
+
+/******************************************************************************
+ * FUNCTION NAME: varyHashMode
+ *
+ * This function compares salted hashing with double hashing for the same 
+ * range of number of hashes as varyHashes()
+ *
+ * RETURNS: void
+ ******************************************************************************/
+void varyHashMode() {
+  unsigned long long int tableSize = 1ULL << 24;
+  unsigned long long int num = 1000000;
+  unsigned long long int queries = 10000000;
+  bloom_parameters salted;
+  bloom_parameters doubleHashing;
+
+  salted.random_seed = 0xA5A5A5A5;
+  doubleHashing.random_seed = 0xA5A5A5A5;
+  doubleHashing.hash_mode = bloom_parameters::double_hashing;
+
+  for ( unsigned int i = 3; i < 10; i++ ) {
+    constituentBFVsOpsPerSec("salted hashes", salted, tableSize, i, num, queries);
+    constituentBFVsOpsPerSec("double hashing", doubleHashing, tableSize, i, num, queries);
+  }
+}
+
+/******************************************************************************
+ * FUNCTION NAME: varyIndexMode
+ *
+ * This function compares the modulo, multiply shift and power of two index
+ * reductions. The table size is deliberately not a power of two so that the
+ * power of two mode shows the effect of rounding the table up
+ *
+ * RETURNS: void
+ ******************************************************************************/
+void varyIndexMode() {
+  unsigned long long int tableSize = 12000000;
+  unsigned long long int num = 1000000;
+  unsigned long long int queries = 10000000;
+  bloom_parameters modulo;
+  bloom_parameters multiplyShift;
+  bloom_parameters powerOfTwo;
+
+  modulo.random_seed = 0xA5A5A5A5;
+  modulo.hash_mode = bloom_parameters::double_hashing;
+  multiplyShift = modulo;
+  multiplyShift.index_mode = bloom_parameters::multiply_shift;
+  powerOfTwo = modulo;
+  powerOfTwo.index_mode = bloom_parameters::power_of_two;
+
+  for ( unsigned int i = 3; i < 10; i += 2 ) {
+    constituentBFVsOpsPerSec("modulo", modulo, tableSize, i, num, queries);
+    constituentBFVsOpsPerSec("multiply shift", multiplyShift, tableSize, i, num, queries);
+    constituentBFVsOpsPerSec("power of two", powerOfTwo, tableSize, i, num, queries);
+  }
+}
+
+/******************************************************************************
+ * FUNCTION NAME: varyPageMode
+ *
+ * This function compares a 256MB constituent BF backed by standard pages,
+ * transparent huge pages and explicit huge pages. Explicit huge pages fall
+ * back to transparent ones unless vm.nr_hugepages is set
+ *
+ * RETURNS: void
+ ******************************************************************************/
+void varyPageMode() {
+  unsigned long long int tableSize = 2147483648ULL;
+  unsigned long long int num = 10000000;
+  unsigned long long int queries = 10000000;
+
+  pageModeVsOpsPerSec("standard pages", bloom_parameters::standard_pages, tableSize, 3, num, queries);
+  pageModeVsOpsPerSec("transparent huge pages", bloom_parameters::transparent_huge_pages, tableSize, 3, num, queries);
+  pageModeVsOpsPerSec("explicit huge pages", bloom_parameters::explicit_huge_pages, tableSize, 3, num, queries);
+}
+
 /******************************************************************************
  * FUNCTION NAME: dynamicResizingStart
  *
@@ -746,6 +2143,20 @@ int main(int argc, char *argv[]) {
   //varyHashes();
   //varyRefreshRate();
   //varyConstituentBFNumbers();
+  //varyConstituentLayout();
+  //varySlicedFBF();
+  //varySummaryFilter();
+  //varyRefreshLatency();
+  //varyRegistrySize();
+  //varyRefreshStagger();
+  //varyConcurrentThreads();
+  //varyShardedFBF();
+  //varyDeltaWriters();
+  //varyRefreshScheduler();
+  //varyBatchContains();
+  //varyHashMode();
+  //varyIndexMode();
+  //varyPageMode();
   dynamicResizingStart(argv[1]);
 
   return SUCCESS;
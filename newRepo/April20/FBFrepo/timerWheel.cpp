@@ -0,0 +1,314 @@
+#ifndef TIMER_WHEEL_CPP
+#define TIMER_WHEEL_CPP
+
+/*
+ * Header files
+ */
+#include <iostream>
+#include <vector>
+
+/*
+ * Macros
+ */
+#define WHEEL_LEVELS 4
+#define WHEEL_SLOT_BITS 6
+#define WHEEL_SLOTS (1U << WHEEL_SLOT_BITS)
+#define WHEEL_NO_TIMER (~0U)
+#define WHEEL_OVERDUE (WHEEL_LEVELS * WHEEL_SLOTS)
+#define DEF_WHEEL_TICK 0.001
+
+using namespace std;
+
+/*
+ * Timer wheel class
+ */
+/*******************************************************************
+ *******************************************************************
+ ** CLASS NAME: timerWheel (Hierarchical timer wheel)
+ **
+ ** NOTE: This class keeps one deadline per timer id and hands back
+ **       the ids whose deadline has passed, in time proportional to
+ **       the ticks elapsed and the timers expiring rather than to
+ **       the number of timers
+ **
+ ** Time is cut into ticks of tickLength. Level 0 has one slot per
+ ** tick for the next WHEEL_SLOTS ticks, each level above has slots
+ ** WHEEL_SLOTS times as wide. A timer sits in the lowest level
+ ** whose range reaches its deadline, in the slot of its deadline.
+ ** When level 0 wraps around, the next slot of level 1 is emptied
+ ** and its timers are placed again, now into level 0, and so on up
+ ** the levels. Deadlines past the top level wait in its last slot
+ **
+ ** The timers of a slot form a doubly linked list threaded through
+ ** the next and prev vectors, so a timer is moved or cancelled in
+ ** constant time
+ *******************************************************************
+ *******************************************************************/
+class timerWheel {
+
+public:
+  /*
+   * Length of a tick and the first tick not processed yet
+   */
+  double tickLength;
+  unsigned long long int currentTick;
+
+  /*
+   * Per timer id: deadline tick, slot (WHEEL_NO_TIMER if the
+   * timer is not scheduled) and links of the slot list
+   */
+  vector<unsigned long long int> expiry;
+  vector<unsigned int> slotOf;
+  vector<unsigned int> next;
+  vector<unsigned int> prev;
+
+  /*
+   * First timer of each slot, level by level, then of the list
+   * of timers scheduled for a tick already processed
+   */
+  unsigned int head[WHEEL_LEVELS * WHEEL_SLOTS + 1];
+
+  /*
+   * Number of scheduled timers
+   */
+  unsigned int scheduled;
+
+  /************************************************************
+   * FUNCTION NAME: timerWheel
+   *
+   * Constructor of the timer wheel class
+   *
+   * PARAMETERS:
+   *            tick: length of a tick, deadlines are rounded down
+   *                  to a tick so a timer fires up to a tick early
+   *            now: current time
+   *
+   * RETURNS: NA
+   ************************************************************/
+  timerWheel(double tick = DEF_WHEEL_TICK, double now = 0) {
+    tickLength = ( tick > 0 ) ? tick : DEF_WHEEL_TICK;
+    currentTick = toTick(now);
+    for ( unsigned int slot = 0; slot <= WHEEL_OVERDUE; slot++ ) {
+      head[slot] = WHEEL_NO_TIMER;
+    }
+    scheduled = 0;
+  }
+
+  /************************************************************
+   * FUNCTION NAME: toTick
+   *
+   * This function maps a time to the tick it falls in
+   *
+   * PARAMETERS:
+   *            time: time to be converted
+   *
+   * RETURNS: the tick
+   ************************************************************/
+  unsigned long long int toTick(double time) {
+    if ( time <= 0 ) {
+      return 0;
+    }
+    return (unsigned long long int) (time / tickLength);
+  }
+
+  /************************************************************
+   * FUNCTION NAME: schedule
+   *
+   * This function sets the deadline of a timer, moving it if
+   * it was already scheduled. A deadline in the past expires at
+   * the next advance
+   *
+   * PARAMETERS:
+   *            id: timer id
+   *            deadline: time at which the timer expires
+   *
+   * RETURNS: void
+   ************************************************************/
+  void schedule(unsigned int id, double deadline) {
+    if ( id >= expiry.size() ) {
+      expiry.resize(id + 1, 0);
+      slotOf.resize(id + 1, WHEEL_NO_TIMER);
+      next.resize(id + 1, WHEEL_NO_TIMER);
+      prev.resize(id + 1, WHEEL_NO_TIMER);
+    }
+    cancel(id);
+    expiry[id] = toTick(deadline);
+    place(id);
+  }
+
+  /************************************************************
+   * FUNCTION NAME: cancel
+   *
+   * This function removes a timer from the wheel
+   *
+   * PARAMETERS:
+   *            id: timer id
+   *
+   * RETURNS: void
+   ************************************************************/
+  void cancel(unsigned int id) {
+    if ( id >= slotOf.size() || WHEEL_NO_TIMER == slotOf[id] ) {
+      return;
+    }
+    if ( WHEEL_NO_TIMER != prev[id] ) {
+      next[prev[id]] = next[id];
+    }
+    else {
+      head[slotOf[id]] = next[id];
+    }
+    if ( WHEEL_NO_TIMER != next[id] ) {
+      prev[next[id]] = prev[id];
+    }
+    slotOf[id] = WHEEL_NO_TIMER;
+    scheduled--;
+  }
+
+  /************************************************************
+   * FUNCTION NAME: place
+   *
+   * This function links a timer into the slot of its deadline
+   * relative to currentTick, or into the overdue list if its
+   * tick has been processed already
+   *
+   * PARAMETERS:
+   *            id: timer id
+   *
+   * RETURNS: void
+   ************************************************************/
+  void place(unsigned int id) {
+    unsigned int slot = WHEEL_OVERDUE;
+    if ( expiry[id] >= currentTick ) {
+      unsigned long long int when = expiry[id];
+      unsigned long long int delta = when - currentTick;
+      unsigned int level = 0;
+      while ( level < WHEEL_LEVELS - 1 && delta >= (1ULL << (WHEEL_SLOT_BITS * (level + 1))) ) {
+        level++;
+      }
+      if ( delta >= (1ULL << (WHEEL_SLOT_BITS * WHEEL_LEVELS)) ) {
+        // Beyond the top level, wait in the slot cascaded last
+        when = currentTick + (1ULL << (WHEEL_SLOT_BITS * WHEEL_LEVELS)) - 1;
+      }
+      slot = level * WHEEL_SLOTS + ((when >> (WHEEL_SLOT_BITS * level)) & (WHEEL_SLOTS - 1));
+    }
+
+    prev[id] = WHEEL_NO_TIMER;
+    next[id] = head[slot];
+    if ( WHEEL_NO_TIMER != head[slot] ) {
+      prev[head[slot]] = id;
+    }
+    head[slot] = id;
+    slotOf[id] = slot;
+    scheduled++;
+  }
+
+  /************************************************************
+   * FUNCTION NAME: cascade
+   *
+   * This function empties a slot of an upper level and places
+   * its timers again, into lower levels
+   *
+   * PARAMETERS:
+   *            level: level of the slot
+   *            index: slot in the level
+   *
+   * RETURNS: void
+   ************************************************************/
+  void cascade(unsigned int level, unsigned int index) {
+    unsigned int id = head[level * WHEEL_SLOTS + index];
+    head[level * WHEEL_SLOTS + index] = WHEEL_NO_TIMER;
+    while ( WHEEL_NO_TIMER != id ) {
+      unsigned int following = next[id];
+      slotOf[id] = WHEEL_NO_TIMER;
+      scheduled--;
+      place(id);
+      id = following;
+    }
+  }
+
+  /************************************************************
+   * FUNCTION NAME: expireSlot
+   *
+   * This function empties a level 0 slot or the overdue list,
+   * appending the timers due at currentTick to expired. Timers
+   * parked beyond the top level are placed again
+   *
+   * PARAMETERS:
+   *            slot: slot to be emptied
+   *            expired: ids of the expired timers
+   *
+   * RETURNS: void
+   ************************************************************/
+  void expireSlot(unsigned int slot, vector<unsigned int> &expired) {
+    unsigned int id = head[slot];
+    head[slot] = WHEEL_NO_TIMER;
+    while ( WHEEL_NO_TIMER != id ) {
+      unsigned int following = next[id];
+      slotOf[id] = WHEEL_NO_TIMER;
+      scheduled--;
+      if ( expiry[id] <= currentTick ) {
+        expired.push_back(id);
+      }
+      else {
+        place(id);
+      }
+      id = following;
+    }
+  }
+
+  /************************************************************
+   * FUNCTION NAME: advance
+   *
+   * This function processes every tick up to time now and
+   * appends the timers that expired to expired, starting with
+   * those scheduled for a tick processed already. An expired
+   * timer is no longer scheduled
+   *
+   * PARAMETERS:
+   *            now: current time
+   *            expired: ids of the expired timers
+   *
+   * RETURNS: void
+   ************************************************************/
+  void advance(double now, vector<unsigned int> &expired) {
+    expireSlot(WHEEL_OVERDUE, expired);
+    if ( now < 0 ) {
+      return;
+    }
+    unsigned long long int last = toTick(now);
+    while ( currentTick <= last ) {
+      if ( 0 == scheduled ) {
+        currentTick = last + 1;
+        break;
+      }
+
+      // Bring down the upper level slots that start at this tick
+      for ( unsigned int level = 1; level < WHEEL_LEVELS; level++ ) {
+        if ( 0 != (currentTick & ((1ULL << (WHEEL_SLOT_BITS * level)) - 1)) ) {
+          break;
+        }
+        cascade(level, (currentTick >> (WHEEL_SLOT_BITS * level)) & (WHEEL_SLOTS - 1));
+      }
+
+      expireSlot(currentTick & (WHEEL_SLOTS - 1), expired);
+      currentTick++;
+    }
+  }
+
+  /*************************************************************
+   * FUNCTION NAME: retNumOfTimers
+   *
+   * This function returns the number of scheduled timers
+   *
+   * RETURN: number of timers
+   *************************************************************/
+  unsigned int retNumOfTimers() {
+    return scheduled;
+  }
+
+}; // End of timerWheel class
+
+#endif
+
+/*
+ * EOF
+ */
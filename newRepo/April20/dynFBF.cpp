@@ -5,6 +5,8 @@
 #include <unistd.h>
 #include <vector>
 #include <mutex>
+#include <condition_variable>
+#include <chrono>
 /*
  * Bloom Filter Library
  */
@@ -19,15 +21,7 @@
 #define FPR_THRESHOLD_RATIO 0.9
 #define BF_INCREASE_FACTOR 2
 #define RR_INCREASE_FACTOR 1
-
-/* 
- * Global variables
- */ 
-unsigned int dfuture = DFUTURE;
-unsigned int dpresent = DFUTURE + 1;
-unsigned int pastStart = DFUTURE + 2;
-unsigned int numberOfBFs;
-unsigned int pastEnd;
+#define MIN_REFRESH_RATE 1
 
 using namespace std;
 
@@ -75,6 +69,25 @@ public:
    */
   std::mutex mtx;
 
+  /*
+   * State of the refresh driver thread, stopDriver is guarded by
+   * driverMtx
+   */
+  std::mutex driverMtx;
+  std::condition_variable driverWakeUp;
+  bool stopDriver;
+
+  /*
+   * Logical generations of the future, present and first past BF,
+   * the number of constituent BFs and the oldest past BF. They are
+   * per instance so that many FBFs can live in one process
+   */
+  unsigned int dfuture;
+  unsigned int dpresent;
+  unsigned int pastStart;
+  unsigned int numberOfBFs;
+  unsigned int pastEnd;
+
   /************************************************************ 
    * FUNCTION NAME: dynFBF 
    *
@@ -112,8 +125,12 @@ public:
     newBF = baseBF;
 
     // Update the class members
+    dfuture = DFUTURE;
+    dpresent = DFUTURE + 1;
+    pastStart = DFUTURE + 2;
     numberOfBFs = numberBFs;
     pastEnd = numberBFs - 1;
+    stopDriver = false;
 
     cout<<" INFO :: dfuture: " <<dfuture <<endl;
     cout<<" INFO :: dpresent: " <<dpresent <<endl;
@@ -135,23 +152,60 @@ public:
   /************************************************************
    * FUNCTION NAME: refreshDriveFunc
    *
-   * This function is the driver function of refresh
+   * This function is the driver function of refresh, run by a
+   * thread of its own. It refreshes the FBF every refreshRate
+   * seconds until stopRefreshDriver() is called, sleeping until
+   * each deadline so the inserting threads never check a clock.
+   * Deadlines stay on the refreshRate grid, a deadline missed
+   * by a slow refresh is skipped rather than caught up
    *
    * PARAMETERS:
-   *            refreshRate: The refresh rate of the FBF
+   *            refreshRate: The refresh rate of the FBF, at least
+   *                         MIN_REFRESH_RATE
    *
    * RETURNS: void
    ************************************************************/
   void refreshDriverFunc(unsigned long refreshRate) {
-    Timer t;
-    t.start();
+    if ( refreshRate < MIN_REFRESH_RATE ) {
+      // A zero period would refresh back to back under mtx
+      cout<<" ERROR :: Refresh rate " <<refreshRate <<" raised to " <<MIN_REFRESH_RATE <<endl;
+      refreshRate = MIN_REFRESH_RATE;
+    }
+    const std::chrono::seconds period(refreshRate);
+    std::unique_lock<std::mutex> lock(driverMtx);
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now();
     cout<<" INFO :: Timer started " <<endl;
-    while( t.getElapsedTime() >= refreshRate ) {
-      refresh();
-      t.start();
+    while ( !stopDriver ) {
+      deadline += period;
+      while ( !stopDriver && std::chrono::steady_clock::now() < deadline ) {
+        driverWakeUp.wait_until(lock, deadline);
+      }
+      if ( !stopDriver ) {
+        refresh();
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        while ( deadline + period <= now ) {
+          deadline += period;
+        }
+      }
     }
   }
 
+  /************************************************************
+   * FUNCTION NAME: stopRefreshDriver
+   *
+   * This function makes refreshDriverFunc return, the thread
+   * running it still has to be joined
+   *
+   * RETURNS: void
+   ************************************************************/
+  void stopRefreshDriver() {
+    {
+      std::lock_guard<std::mutex> guard(driverMtx);
+      stopDriver = true;
+    }
+    driverWakeUp.notify_all();
+  }
+
   /************************************************************
    * FUNCTION NAME: refresh
    * 
@@ -161,16 +215,13 @@ public:
    ************************************************************/
   void refresh() { 
 
+    // The inserts of another thread wait for the whole shift, the
+    // future BF is only replaced after the loop
+    std::lock_guard<std::mutex> guard(mtx);
     unsigned int j;
     for ( j = (numberOfBFs - 1); j > 0; j-- ) {
-      if ( 0 == j || 1 == j ) {
-    	  mtx.lock();
-      }
       dyn_fbf[j].clear();
       dyn_fbf[j] = dyn_fbf[j - 1];
-      if ( 0 == j || 1 == j ) {
-        mtx.unlock();
-      }
     }
 
     dyn_fbf[j].clear();
@@ -485,7 +536,7 @@ public:
 
       cout<<endl<<" INFO :: Individual FPP here: " <<endl;
       cout<<" INFO :: Future BF FPP: " <<dyn_fbf[dfuture].effective_fpp() <<endl;
-      for ( unsigned int i = present; i <= pastEnd; i++ ) {
+      for ( unsigned int i = dpresent; i <= pastEnd; i++ ) {
         cout<<" INFO :: " <<i <<"BF FPP: " <<dyn_fbf[i].effective_modified_fpp() <<endl;
       }
 
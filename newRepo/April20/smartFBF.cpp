@@ -289,7 +289,8 @@ void numberOfBFsVsOpsPerSec(unsigned long numberOfBFs,
    */
   dynFBF dyn_FBF(numberOfBFs, tableSize, numOfHashes);
 
-  thread refereshThread (refreshDriver, dyn_FBF, refreshRate);
+  // The thread refreshes dyn_FBF itself, not a copy of it
+  thread refereshThread (refreshDriver, std::ref(dyn_FBF), refreshRate);
 
   /* 
    * STEP 2: Insert some numbers in to the FBF
@@ -316,6 +317,8 @@ void numberOfBFsVsOpsPerSec(unsigned long numberOfBFs,
    * STEP 3: Measure the operations per second done 
    */
   double elapsedLoopTime = loopTime.getElapsedTime();
+  dyn_FBF.stopRefreshDriver();
+  refereshThread.join();
   cout<<" INFO :: Time elapsed in for loop: " <<elapsedLoopTime <<endl;
   cout<<" INFO :: Rate of insertion: " <<(double)numElements/elapsedLoopTime <<"per second" <<endl;
 